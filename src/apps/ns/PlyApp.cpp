@@ -59,6 +59,7 @@
 #include <gvt/render/algorithm/Tracers.h>
 #include <gvt/render/data/Primitives.h>
 #include <gvt/render/data/scene/Image.h>
+#include <gvt/render/data/scene/TimeSeries.h>
 #include <gvt/render/data/scene/gvtCamera.h>
 
 #include "ParseCommandLine.h"
@@ -106,6 +107,16 @@ int main(int argc, char **argv) {
   cmd.addoption("image", ParseCommandLine::NONE, "Use embeded scene", 0);
   cmd.addoption("domain", ParseCommandLine::NONE, "Use embeded scene", 0);
   cmd.addoption("threads", ParseCommandLine::INT, "Number of threads to use (default number cores + ht)", 1);
+  cmd.addoption("acomm", ParseCommandLine::NONE, "Use the asynchronous communicator", 0);
+  cmd.addoption("minbatch", ParseCommandLine::INT, "Minimum number of rays in a queue to trace it (default 1)", 1);
+  cmd.addoption("batchtimeout", ParseCommandLine::FLOAT, "Idle time (ms) before tracing queues below minbatch", 1);
+  cmd.addoption("sendbatch", ParseCommandLine::INT, "Number of rays per message sent to another node (default 4096)", 1);
+  cmd.addoption("sendtimeout", ParseCommandLine::FLOAT, "Maximum time (ms) a ray waits to be sent (default 1)", 1);
+  cmd.addoption("sendcredits", ParseCommandLine::INT, "Maximum rays in flight to each node (default 65536)", 1);
+  cmd.addoption("maxqueued", ParseCommandLine::INT, "Queued rays above which a node stops accepting rays", 1);
+  cmd.addoption("noderouting", ParseCommandLine::NONE, "Route rays to other compute nodes through one rank per node", 0);
+  cmd.addoption("timesteps", ParseCommandLine::INT,
+                "Number of time steps, step t is read from <file>/t and loaded while the previous step renders", 1);
   cmd.addoption("embree", ParseCommandLine::NONE, "Embree Adapter Type", 0);
   cmd.addoption("embree-stream", ParseCommandLine::NONE, "Embree Adapter Type (Stream)", 0);
   cmd.addoption("manta", ParseCommandLine::NONE, "Manta Adapter Type", 0);
@@ -134,7 +145,10 @@ int main(int argc, char **argv) {
 
   // MPI_Init(&argc, &argv);
   // MPI_Pcontrol(0);
-  gvt::comm::scomm::init(argc, argv);
+  if (cmd.isSet("acomm"))
+    gvt::comm::acomm::init(argc, argv);
+  else
+    gvt::comm::scomm::init(argc, argv);
   int rank = -1;
   MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 
@@ -159,15 +173,20 @@ int main(int argc, char **argv) {
   gvt::core::DBNodeH dataNodes = root["Data"];
   gvt::core::DBNodeH instNodes = root["Instances"];
 
-  gvt::render::data::domain::reader::PlyReader plyReader(cmd.get<std::string>("file"), true);
+  // a time series reads its first step now, the next steps are streamed while rendering
+  const int timesteps = cmd.isSet("timesteps") ? cmd.get<int>("timesteps") : 0;
+  const std::string plydir = cmd.get<std::string>("file");
+  gvt::render::data::domain::reader::PlyReader plyReader(timesteps ? plydir + "/0" : plydir, cmd.isSet("domain"));
 
   // context has the location information of the domain, so for simplicity only one mpi will create the instances
   if (MPI::COMM_WORLD.Get_rank() == 0) {
-    for (int k = 0; k < plyReader.getMeshes().size(); k++) {
+    // the meshes are spread over the ranks, the mesh nodes and their bounds are known to all of them
+    gvt::core::Vector<gvt::core::DBNodeH> meshNodes = dataNodes.getChildren();
+    for (int k = 0; k < meshNodes.size(); k++) {
 
       // add instance
       gvt::core::DBNodeH instnode = cntxt->createNodeFromType("Instance", "inst", instNodes.UUID());
-      gvt::core::DBNodeH meshNode = dataNodes.getChildren()[k];
+      gvt::core::DBNodeH meshNode = meshNodes[k];
       Box3D *mbox = (Box3D *)meshNode["bbox"].value().toULongLong();
       instnode["id"] = k;
       instnode["meshRef"] = meshNode.UUID();
@@ -230,6 +249,13 @@ int main(int argc, char **argv) {
     schedNode["type"] = gvt::render::scheduler::Domain;
   else
     schedNode["type"] = gvt::render::scheduler::Image;
+  if (cmd.isSet("minbatch")) schedNode["minBatch"] = cmd.get<int>("minbatch");
+  if (cmd.isSet("batchtimeout")) schedNode["batchTimeout"] = cmd.get<float>("batchtimeout");
+  if (cmd.isSet("sendbatch")) schedNode["sendBatch"] = cmd.get<int>("sendbatch");
+  if (cmd.isSet("sendtimeout")) schedNode["sendTimeout"] = cmd.get<float>("sendtimeout");
+  if (cmd.isSet("sendcredits")) schedNode["sendCredits"] = cmd.get<int>("sendcredits");
+  if (cmd.isSet("maxqueued")) schedNode["maxQueued"] = cmd.get<int>("maxqueued");
+  if (cmd.isSet("noderouting")) schedNode["nodeRouting"] = true;
 
   string adapter("embree");
 
@@ -302,12 +328,29 @@ int main(int argc, char **argv) {
   cntxt->settracer(rt);
 
   std::cout << "Calling tracer" << std::endl;
-  for (int i = 0; i < 100; i++) {
-    (*rt)();
+  if (timesteps) {
+    gvt::core::Vector<std::string> names;
+    for (gvt::core::DBNodeH meshNode : dataNodes.getChildren()) names.push_back(meshNode.value().toString());
+    auto load = [&](const std::string &name, const int step) {
+      const std::string file = name.substr(name.find_last_of('/') + 1);
+      return gvt::render::data::domain::reader::PlyReader::readMesh(plydir + "/" + std::to_string(step) + "/" + file);
+    };
+    gvt::render::data::scene::TimeSeries series(names, timesteps, load, [&](Mesh *m) { rt->prepareAdapter(m); },
+                                                [&](Mesh *m) { rt->releaseAdapter(m); });
+    do {
+      if (series.step() > 0) rt->resetBVH();
+      (*rt)();
+      if (gvt::comm::communicator::instance().id() == 0)
+        (*rt).getComposite()->write(filmNode["outputPath"].value().toString() + "_" + std::to_string(series.step()));
+    } while (series.advance());
+  } else {
+    for (int i = 0; i < 100; i++) {
+      (*rt)();
+    }
+    if (gvt::comm::communicator::instance().id() == 0)
+      (*rt).getComposite()->write(filmNode["outputPath"].value().toString());
   }
 
-  if (gvt::comm::communicator::instance().id() == 0)
-    (*rt).getComposite()->write(filmNode["outputPath"].value().toString());
   gvt::comm::communicator::instance().terminate();
 
   }
@@ -98,6 +98,14 @@ int main(int argc, char **argv) {
   cmd.addoption("image", ParseCommandLine::NONE, "Use embeded scene", 0);
   cmd.addoption("domain", ParseCommandLine::NONE, "Use embeded scene", 0);
   cmd.addoption("threads", ParseCommandLine::INT, "Number of threads to use (default number cores + ht)", 1);
+  cmd.addoption("acomm", ParseCommandLine::NONE, "Use the asynchronous communicator", 0);
+  cmd.addoption("minbatch", ParseCommandLine::INT, "Minimum number of rays in a queue to trace it (default 1)", 1);
+  cmd.addoption("batchtimeout", ParseCommandLine::FLOAT, "Idle time (ms) before tracing queues below minbatch", 1);
+  cmd.addoption("sendbatch", ParseCommandLine::INT, "Number of rays per message sent to another node (default 4096)", 1);
+  cmd.addoption("sendtimeout", ParseCommandLine::FLOAT, "Maximum time (ms) a ray waits to be sent (default 1)", 1);
+  cmd.addoption("sendcredits", ParseCommandLine::INT, "Maximum rays in flight to each node (default 65536)", 1);
+  cmd.addoption("maxqueued", ParseCommandLine::INT, "Queued rays above which a node stops accepting rays", 1);
+  cmd.addoption("noderouting", ParseCommandLine::NONE, "Route rays to other compute nodes through one rank per node", 0);
   cmd.addoption("output", ParseCommandLine::PATH, "Output Image Path", 1);
   cmd.addconflict("image", "domain");
 
@@ -121,7 +129,10 @@ int main(int argc, char **argv) {
     init = new tbb::task_scheduler_init(cmd.get<int>("threads"));
   }
 
-  gvt::comm::scomm::init(argc, argv);
+  if (cmd.isSet("acomm"))
+    gvt::comm::acomm::init(argc, argv);
+  else
+    gvt::comm::scomm::init(argc, argv);
   // MPI_Init(&argc, &argv);
   // MPI_Pcontrol(0);
   int rank = -1;
@@ -411,6 +422,13 @@ int main(int argc, char **argv) {
     schedNode["type"] = gvt::render::scheduler::Domain;
   else
     schedNode["type"] = gvt::render::scheduler::Image;
+  if (cmd.isSet("minbatch")) schedNode["minBatch"] = cmd.get<int>("minbatch");
+  if (cmd.isSet("batchtimeout")) schedNode["batchTimeout"] = cmd.get<float>("batchtimeout");
+  if (cmd.isSet("sendbatch")) schedNode["sendBatch"] = cmd.get<int>("sendbatch");
+  if (cmd.isSet("sendtimeout")) schedNode["sendTimeout"] = cmd.get<float>("sendtimeout");
+  if (cmd.isSet("sendcredits")) schedNode["sendCredits"] = cmd.get<int>("sendcredits");
+  if (cmd.isSet("maxqueued")) schedNode["maxQueued"] = cmd.get<int>("maxqueued");
+  if (cmd.isSet("noderouting")) schedNode["nodeRouting"] = true;
 
   string adapter("embree");
 
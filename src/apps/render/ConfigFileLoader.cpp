@@ -30,8 +30,11 @@
 
 #include "ConfigFileLoader.h"
 
+#include <gvt/render/data/reader/DomainPlacement.h>
 #include <gvt/render/data/reader/ObjReader.h>
+#include <gvt/render/data/reader/SharedMesh.h>
 
+#include <algorithm>
 #include <boost/regex.h>
 #include <boost/regex.hpp>
 #include <fstream>
@@ -42,6 +45,8 @@
 #include <sstream>
 
 using namespace gvtapps::render;
+using gvt::render::data::domain::reader::DomainPlacement;
+using gvt::render::data::domain::reader::SharedMesh;
 
 namespace gvtapps {
 namespace render {
@@ -68,7 +73,7 @@ gvt::core::Vector<std::string> split(const std::string &s, char delim, gvt::core
 /**
     \param filename configuration file
 */
-ConfigFileLoader::ConfigFileLoader(const std::string filename) {
+ConfigFileLoader::ConfigFileLoader(const std::string filename, bool dist) {
 
   GVT_ASSERT(filename.size() > 0, "Error filename not specified");
   std::fstream file;
@@ -83,8 +88,15 @@ ConfigFileLoader::ConfigFileLoader(const std::string filename) {
   gvt::core::DBNodeH dataNodes = root["Data"];
   gvt::core::DBNodeH instNodes = root["Instances"];
 
-  gvt::core::Map<std::string, gvt::render::data::primitives::Mesh *> meshes;
-  gvt::core::Map<gvt::render::data::primitives::Mesh *, gvt::core::DBNodeH> meshestoDBNode;
+  /// instance of a mesh file, created once the meshes are loaded
+  struct MeshInstance {
+    std::string file;
+    glm::mat4 *m;
+    glm::mat4 *minv;
+    glm::mat3 *normi;
+  };
+  gvt::core::Vector<std::string> objFiles;
+  gvt::core::Vector<MeshInstance> instances;
 
   int domainCount = 0;
 
@@ -127,47 +139,14 @@ ConfigFileLoader::ConfigFileLoader(const std::string filename) {
     } else if (elems[0] == "G") {
 
       // gvt::render::data::domain::GeometryDomain *domain = NULL;
-      gvt::render::data::primitives::Mesh *mesh;
-
       glm::mat4 *m = new glm::mat4(1.f);
       glm::mat4 *minv = new glm::mat4(1.f);
       glm::mat3 *normi = new glm::mat3(1.f);
 
-      gvt::core::DBNodeH meshNode;
-
       if (elems[1].find(".obj") < elems[1].size()) {
 
-        gvt::core::Map<std::string, gvt::render::data::primitives::Mesh *>::iterator meshIt = meshes.find(elems[1]);
-
-        if (meshIt != meshes.end()) {
-          mesh = meshIt->second;
-          meshNode = meshestoDBNode[mesh];
-        } else {
-          gvt::render::data::domain::reader::ObjReader objReader(elems[1]);
-          mesh = objReader.getMesh();
-          meshes[elems[1]] = mesh;
-
-          if (MPI::COMM_WORLD.Get_rank() == 0)
-            cntxt->addToSync(cntxt->createNodeFromType("Mesh", filename.c_str(), dataNodes.UUID()));
-
-          cntxt->syncContext();
-
-          meshNode = dataNodes.getChildren().back();
-
-          meshNode["file"] = filename;
-          gvt::render::data::primitives::Box3D *bbox = mesh->getBoundingBox();
-          meshNode["bbox"] = (unsigned long long)bbox;
-          meshNode["ptr"] = (unsigned long long)mesh;
-
-          gvt::core::DBNodeH loc = cntxt->createNode("rank", MPI::COMM_WORLD.Get_rank());
-          meshNode["Locations"] += loc;
-
-          cntxt->addToSync(meshNode);
-
-          meshestoDBNode[mesh] = meshNode;
-        }
-
-        mesh->generateNormals();
+        // the meshes are loaded once the whole file is read, when their placement can be decided
+        if (std::find(objFiles.begin(), objFiles.end(), elems[1]) == objFiles.end()) objFiles.push_back(elems[1]);
 
         glm::vec3 t;
         t[0] = std::atof(elems[2].c_str());
@@ -202,31 +181,14 @@ ConfigFileLoader::ConfigFileLoader(const std::string filename) {
           *minv = glm::inverse(*m);
           *normi = glm::transpose(glm::inverse(glm::mat3(*m)));
         }
+
+        MeshInstance instance = { elems[1], m, minv, normi };
+        instances.push_back(instance);
       }
       if (elems[1].find(".ply") < elems[1].size()) {
         GVT_ERR_MESSAGE("Found ply file : " << elems[1].find(".ply"));
       }
 
-      if (MPI::COMM_WORLD.Get_rank() == 0) {
-        // add instance
-        gvt::core::DBNodeH instnode = cntxt->createNodeFromType("Instance", "inst", instNodes.UUID());
-        gvt::render::data::primitives::Box3D *mbox =
-            (gvt::render::data::primitives::Box3D *)meshNode["bbox"].value().toULongLong();
-        instnode["id"] = domainCount++;
-        instnode["meshRef"] = meshNode.UUID();
-
-        instnode["mat"] = (unsigned long long)m;
-        instnode["matInv"] = (unsigned long long)minv;
-        instnode["normi"] = (unsigned long long)normi;
-
-        auto il = glm::vec3((*m) * glm::vec4(mbox->bounds_min, 1.f));
-        auto ih = glm::vec3((*m) * glm::vec4(mbox->bounds_max, 1.f));
-        gvt::render::data::primitives::Box3D *ibox = new gvt::render::data::primitives::Box3D(il, ih);
-        instnode["bbox"] = (unsigned long long)ibox;
-        instnode["centroid"] = ibox->centroid();
-        cntxt->addToSync(instnode);
-      }
-
     } else if (elems[0] == "LP") {
       glm::vec3 pos, color;
       pos[0] = std::atof(elems[1].c_str());
@@ -282,6 +244,83 @@ ConfigFileLoader::ConfigFileLoader(const std::string filename) {
     }
   }
 
+  // a mesh node per file, with the load cost used to place the meshes
+  const int rank = MPI::COMM_WORLD.Get_rank();
+  if (rank == 0) {
+    for (const std::string &objFile : objFiles) {
+      gvt::core::DBNodeH meshNode = cntxt->createNodeFromType("Mesh", objFile, dataNodes.UUID());
+      meshNode += cntxt->createNode(DomainPlacement::COST, DomainPlacement::fileCost(objFile));
+      cntxt->addToSync(meshNode);
+    }
+  }
+  cntxt->syncContext();
+
+  gvt::core::Map<std::string, gvt::core::DBNodeH> meshNodes;
+  gvt::core::Vector<gvt::core::DBNodeH> objNodes;
+  for (gvt::core::DBNodeH node : dataNodes.getChildren()) {
+    const std::string objFile = node.value().toString();
+    if (std::find(objFiles.begin(), objFiles.end(), objFile) == objFiles.end()) continue;
+    meshNodes[objFile] = node;
+    objNodes.push_back(node);
+  }
+
+  // distributed scenes are loaded only by the rank hosting each mesh, otherwise by every rank, the ranks of a
+  // node sharing one copy
+  const gvt::core::Vector<int> placement = dist ? DomainPlacement::assign(objNodes) : gvt::core::Vector<int>();
+  gvt::core::Vector<gvt::render::data::primitives::Mesh *> meshes(objNodes.size(), NULL);
+  for (size_t i = 0; i < objNodes.size(); i++) {
+    if (dist ? placement[i] != rank : !SharedMesh::loads(i)) continue;
+    gvt::render::data::domain::reader::ObjReader objReader(objNodes[i].value().toString());
+    meshes[i] = objReader.getMesh();
+    meshes[i]->generateNormals();
+  }
+  if (!dist) SharedMesh::share(meshes);
+
+  for (size_t i = 0; i < objNodes.size(); i++) {
+    gvt::render::data::primitives::Mesh *mesh = meshes[i];
+    if (!mesh) continue;
+    gvt::core::DBNodeH meshNode = objNodes[i];
+    const std::string objFile = meshNode.value().toString();
+
+    meshNode["file"] = objFile;
+    meshNode["bbox"] = (unsigned long long)mesh->getBoundingBox();
+    meshNode["ptr"] = (unsigned long long)mesh;
+
+    gvt::core::DBNodeH loc = cntxt->createNode("rank", rank);
+    meshNode["Locations"] += loc;
+
+    cntxt->addToSync(meshNode);
+  }
+  cntxt->syncContext();
+
+  // the mesh bounds are now known to all ranks
+  if (rank == 0) {
+    for (const MeshInstance &instance : instances) {
+      gvt::core::DBNodeH meshNode = meshNodes[instance.file];
+      glm::mat4 *m = instance.m;
+      glm::mat4 *minv = instance.minv;
+      glm::mat3 *normi = instance.normi;
+
+      // add instance
+      gvt::core::DBNodeH instnode = cntxt->createNodeFromType("Instance", "inst", instNodes.UUID());
+      gvt::render::data::primitives::Box3D *mbox =
+          (gvt::render::data::primitives::Box3D *)meshNode["bbox"].value().toULongLong();
+      instnode["id"] = domainCount++;
+      instnode["meshRef"] = meshNode.UUID();
+
+      instnode["mat"] = (unsigned long long)m;
+      instnode["matInv"] = (unsigned long long)minv;
+      instnode["normi"] = (unsigned long long)normi;
+
+      auto il = glm::vec3((*m) * glm::vec4(mbox->bounds_min, 1.f));
+      auto ih = glm::vec3((*m) * glm::vec4(mbox->bounds_max, 1.f));
+      gvt::render::data::primitives::Box3D *ibox = new gvt::render::data::primitives::Box3D(il, ih);
+      instnode["bbox"] = (unsigned long long)ibox;
+      instnode["centroid"] = ibox->centroid();
+      cntxt->addToSync(instnode);
+    }
+  }
+
   cntxt->syncContext();
 }
 
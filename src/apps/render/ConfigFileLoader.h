@@ -54,9 +54,10 @@ namespace render {
 */
 class ConfigFileLoader {
 public:
-  /** Constructor that utilizes the file name of the gvt config file.
+  /** Constructor that utilizes the file name of the gvt config file. With dist set, each mesh is
+  loaded only by the rank it is placed on instead of by every rank.
   */
-  ConfigFileLoader(const std::string filename = "");
+  ConfigFileLoader(const std::string filename = "", bool dist = false);
   /** Copy constructor.
   */
   ConfigFileLoader(const ConfigFileLoader &orig);
@@ -1144,7 +1144,7 @@ int main(int argc, char *argv[]) {
   if (cmd.isSet("file"))
     ConfigPly(cmd.get<std::string>("file"));
   else if (cmd.isSet("scene"))
-    gvtapps::render::ConfigFileLoader cl(cmd.get<std::string>("scene"));
+    gvtapps::render::ConfigFileLoader cl(cmd.get<std::string>("scene"), cmd.isSet("domain"));
   else
     ConfigSceneCubeCone();
 
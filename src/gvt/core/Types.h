@@ -25,11 +25,13 @@
 #define GVT_CORE_TYPES_H
 
 #include <gvt/core/Math.h>
+#include <gvt/core/context/Atom.h>
 #include <gvt/core/context/Uuid.h>
 #include <gvt/core/context/Variant.h>
 
 #include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 namespace gvt {
@@ -37,6 +39,7 @@ namespace core {
 typedef std::string String;
 template <class T> using Vector = std::vector<T>;
 template <class K, class V> using Map = std::map<K, V>;
+template <class K, class V> using HashMap = std::unordered_map<K, V>;
 }
 }
 
@@ -0,0 +1,141 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+#include <gvt/core/comm/bufferpool.h>
+#include <gvt/core/comm/communicator.h>
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <mpi.h>
+#include <new>
+
+namespace gvt {
+namespace comm {
+
+BufferPool &BufferPool::instance() {
+  // never destroyed, messages owned by other static objects may be released during exit (after MPI_Finalize)
+  static BufferPool *pool = new BufferPool;
+  return *pool;
+}
+
+BufferPool::~BufferPool() { clear(); }
+
+namespace {
+bool mpiActive() {
+  int initialized = 0, finalized = 0;
+  MPI_Initialized(&initialized);
+  if (initialized) MPI_Finalized(&finalized);
+  return initialized && !finalized;
+}
+}
+
+std::size_t BufferPool::sizeClass(const std::size_t size) {
+  std::size_t c = MIN_CLASS;
+  while ((std::size_t(1) << c) < size) c++;
+  assert(c <= MAX_CLASS);
+  return c;
+}
+
+BufferPool::Byte *BufferPool::allocate(const std::size_t capacity) {
+  const std::size_t bytes = capacity + sizeof(block) + CACHE_LINE - 1;
+  void *base = nullptr;
+  bool registered = false;
+
+  if (mpiActive()) {
+    // buffers are acquired from TBB workers, MPI calls must be serialized with the communicator
+    std::shared_ptr<communicator> comm = communicator::_instance;
+    if (comm) comm->aquireComm();
+    registered = (MPI_Alloc_mem(bytes, MPI_INFO_NULL, &base) == MPI_SUCCESS);
+    if (comm) comm->releaseComm();
+  }
+  if (!registered) base = std::malloc(bytes);
+  if (!base) throw std::bad_alloc();
+
+  const std::uintptr_t first = reinterpret_cast<std::uintptr_t>(base) + sizeof(block);
+  Byte *buf = reinterpret_cast<Byte *>((first + CACHE_LINE - 1) & ~std::uintptr_t(CACHE_LINE - 1));
+  block &b = getBlock(buf);
+  b.base = base;
+  b.capacity = capacity;
+  b.registered = registered;
+  return buf;
+}
+
+void BufferPool::deallocate(Byte *buf) {
+  block &b = getBlock(buf);
+  if (!b.registered) {
+    std::free(b.base);
+  } else if (mpiActive()) {
+    std::shared_ptr<communicator> comm = communicator::_instance;
+    if (comm) comm->aquireComm();
+    MPI_Free_mem(b.base);
+    if (comm) comm->releaseComm();
+  }
+  // registered memory can not be returned after MPI_Finalize, the process is exiting anyway
+}
+
+BufferPool::Byte *BufferPool::acquire(const std::size_t size) {
+  const std::size_t c = sizeClass(size);
+  {
+    std::lock_guard<std::mutex> l(_mpool);
+    if (!_free[c].empty()) {
+      Byte *buf = _free[c].back();
+      _free[c].pop_back();
+      _cached -= std::size_t(1) << c;
+      return buf;
+    }
+  }
+  return allocate(std::size_t(1) << c);
+}
+
+void BufferPool::release(Byte *buf) {
+  if (!buf) return;
+  const std::size_t cap = capacity(buf);
+  {
+    std::lock_guard<std::mutex> l(_mpool);
+    if (_cached + cap <= _limit) {
+      _free[sizeClass(cap)].push_back(buf);
+      _cached += cap;
+      return;
+    }
+  }
+  deallocate(buf);
+}
+
+std::size_t BufferPool::capacity(const Byte *buf) { return getBlock(buf).capacity; }
+
+void BufferPool::limit(const std::size_t bytes) {
+  std::lock_guard<std::mutex> l(_mpool);
+  _limit = bytes;
+}
+
+void BufferPool::clear() {
+  std::lock_guard<std::mutex> l(_mpool);
+  for (auto &list : _free) {
+    for (Byte *buf : list) deallocate(buf);
+    list.clear();
+  }
+  _cached = 0;
+}
+}
+}
@@ -0,0 +1,117 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+#ifndef GVT_CORE_BUFFER_POOL_H
+#define GVT_CORE_BUFFER_POOL_H
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace gvt {
+namespace comm {
+
+/**
+ * @brief Reusable communication buffer pool
+ *
+ * Message buffers are allocated in power of two size classes and returned to the pool when the message is destroyed,
+ * so the steady state of the communication layer does not allocate memory. If MPI is initialized the buffers are
+ * allocated with MPI_Alloc_mem, which allows the MPI library to register (pin) them once for RDMA transfers instead of
+ * on every send and receive.
+ *
+ * All buffers are aligned to CACHE_LINE bytes, so any type (e.g. rays) can be built in place or adopted directly from a
+ * received buffer.
+ */
+struct BufferPool {
+  typedef unsigned char Byte;
+
+  static const std::size_t CACHE_LINE = 64; /**< Buffer alignment */
+  static const std::size_t MIN_CLASS = 8;   /**< Smallest size class (2^MIN_CLASS bytes) */
+  static const std::size_t MAX_CLASS = 48;  /**< Largest size class (2^MAX_CLASS bytes) */
+
+  /**
+   * @brief Process wide buffer pool
+   */
+  static BufferPool &instance();
+
+  /**
+   * @brief Get a buffer with at least size bytes
+   * @param size Minimum buffer size in bytes
+   * @return Aligned buffer, the buffer must be returned with release
+   */
+  Byte *acquire(const std::size_t size);
+
+  /**
+   * @brief Return a buffer to the pool
+   *
+   * If the pool already caches more than limit bytes the buffer memory is freed.
+   *
+   * @param buf Buffer obtained with acquire (nullptr is ignored)
+   */
+  void release(Byte *buf);
+
+  /**
+   * @brief Usable size of a buffer
+   * @param buf Buffer obtained with acquire
+   * @return Buffer capacity in bytes
+   */
+  static std::size_t capacity(const Byte *buf);
+
+  /**
+   * @brief Set the maximum number of bytes cached by the pool
+   */
+  void limit(const std::size_t bytes);
+
+  /**
+   * @brief Free all cached buffers
+   */
+  void clear();
+
+  ~BufferPool();
+
+protected:
+  /**
+   * @brief Bookkeeping stored in front of every buffer
+   */
+  struct block {
+    void *base;           /**< Address returned by the allocator */
+    std::size_t capacity; /**< Usable bytes after the block */
+    bool registered;      /**< True if allocated with MPI_Alloc_mem */
+  };
+
+  static block &getBlock(const Byte *buf) {
+    return *reinterpret_cast<block *>(const_cast<Byte *>(buf) - sizeof(block));
+  }
+  static std::size_t sizeClass(const std::size_t size);
+  static Byte *allocate(const std::size_t capacity);
+  static void deallocate(Byte *buf);
+
+  std::mutex _mpool;                         /**< Free list mutex */
+  std::vector<Byte *> _free[MAX_CLASS + 1];  /**< Free buffers per size class */
+  std::size_t _cached = 0;                   /**< Bytes held in the free lists */
+  std::size_t _limit = std::size_t(1) << 28; /**< Maximum bytes held in the free lists */
+};
+}
+}
+
+#endif /* GVT_CORE_BUFFER_POOL_H */
@@ -24,10 +24,13 @@
 #ifndef GVT_COMM_LAYER
 #define GVT_COMM_LAYER
 
+#include <gvt/core/comm/bufferpool.h>
+#include <gvt/core/comm/shmtransport.h>
 #include <gvt/core/comm/communicator.h>
 #include <gvt/core/comm/communicator/acomm.h>
 #include <gvt/core/comm/communicator/scomm.h>
 #include <gvt/core/comm/message.h>
+#include <gvt/core/comm/termination/termination.h>
 #include <gvt/core/comm/vote/vote.h>
 
 #endif /*GVT_COMM_LAYER*/
@@ -23,9 +23,12 @@
    ======================================================================================= */
 #include <gvt/core/comm/communicator.h>
 
+#include <algorithm>
 #include <cassert>
+#include <cstdlib>
 #include <iostream>
 #include <mpi.h>
+#include <thread>
 
 namespace gvt {
 namespace comm {
@@ -42,8 +45,88 @@ communicator::communicator() {
   // _size = MPI::COMM_WORLD.Get_size();
   MPI_Comm_rank(MPI_COMM_WORLD, &_id);
   MPI_Comm_size(MPI_COMM_WORLD, &_size);
+
+  // Node topology, the leader of a node is its lowest rank
+  MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, _id, MPI_INFO_NULL, &_node_comm);
+  int leader = _id;
+  MPI_Bcast(&leader, 1, MPI_INT, 0, _node_comm);
+  _leader.resize(_size);
+  MPI_Allgather(&leader, 1, MPI_INT, &_leader[0], 1, MPI_INT, MPI_COMM_WORLD);
+
+  _local_index.resize(_size);
+  _node_index.resize(_size);
+  for (int r = 0; r < _size; r++) {
+    std::vector<int> &local = _node_ranks[_leader[r]];
+    _local_index[r] = local.size();
+    local.push_back(r);
+    if (_leader[r] == r) _leaders.push_back(r);
+  }
+  for (int r = 0; r < _size; r++)
+    _node_index[r] = std::lower_bound(_leaders.begin(), _leaders.end(), _leader[r]) - _leaders.begin();
+}
+
+communicator::~communicator() {
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  _shm_ready = nullptr;
+  _shm.reset();
+  if (!finalized && _node_comm != MPI_COMM_NULL) MPI_Comm_free(&_node_comm);
+}
+
+namespace {
+// Binomial tree over n positions rooted at position 0
+void binomialChildren(const int i, const int n, std::vector<int> &children) {
+  int m = 1;
+  while (m <= i) m <<= 1;
+  for (; i + m < n; m <<= 1) children.push_back(i + m);
+}
+
+int binomialParent(const int i) {
+  int m = 1;
+  while ((m << 1) <= i) m <<= 1;
+  return i - m;
+}
+}
+
+void communicator::treeChildren(const int root, const int rank, std::vector<int> &children) {
+  children.clear();
+  // the root enters its own node, the leader enters every other node
+  auto entry = [&](const int leader) { return (leader == _leader[root]) ? root : leader; };
+
+  const std::vector<int> &local = _node_ranks[_leader[rank]];
+  const int M = local.size();
+  const int pe = _local_index[entry(_leader[rank])];
+
+  if (rank == entry(_leader[rank])) {
+    const int N = _leaders.size();
+    const int nr = _node_index[root];
+    std::vector<int> nodes;
+    binomialChildren((_node_index[rank] - nr + N) % N, N, nodes);
+    // remote nodes first, their subtrees are the most expensive
+    for (auto it = nodes.rbegin(); it != nodes.rend(); ++it) children.push_back(entry(_leaders[(*it + nr) % N]));
+  }
+
+  std::vector<int> ranks;
+  binomialChildren((_local_index[rank] - pe + M) % M, M, ranks);
+  for (auto it = ranks.rbegin(); it != ranks.rend(); ++it) children.push_back(local[(*it + pe) % M]);
+}
+
+int communicator::treeParent(const int root, const int rank) {
+  if (rank == root) return -1;
+  auto entry = [&](const int leader) { return (leader == _leader[root]) ? root : leader; };
+
+  const int e = entry(_leader[rank]);
+  if (rank != e) {
+    const std::vector<int> &local = _node_ranks[_leader[rank]];
+    const int M = local.size();
+    const int pe = _local_index[e];
+    return local[(binomialParent((_local_index[rank] - pe + M) % M) + pe) % M];
+  }
+
+  const int N = _leaders.size();
+  const int nr = _node_index[root];
+  return entry(_leaders[(binomialParent((_node_index[rank] - nr + N) % N) + nr) % N]);
 }
-communicator::~communicator() {}
 
 void communicator::init(int argc, char *argv[], bool start_thread) {
   assert(communicator::_instance);
@@ -77,14 +160,34 @@ void communicator::terminate() {
   //MPI_Finalize();
 }
 
-inline void communicator::aquireComm() {
+void communicator::aquireComm() {
   if (communicator::_MPI_THREAD_SERIALIZED) _mcomm.lock();
 }
 
-inline void communicator::releaseComm() {
+void communicator::releaseComm() {
   if (communicator::_MPI_THREAD_SERIALIZED) _mcomm.unlock();
 }
 
+void communicator::enableSharedTransport() {
+  if (shm() || _node_ranks[_leader[_id]].size() < 2) return;
+  const char *env = getenv("GVT_SHM_TRANSPORT");
+  if (env && std::string(env) == "0") return;
+  const char *bytes = getenv("GVT_SHM_RING_BYTES");
+  std::size_t ring = bytes ? std::strtoull(bytes, nullptr, 10) : 0;
+  if (ring == 0) ring = ShmTransport::DEFAULT_RING_BYTES;
+
+  // collective over the node, the communication thread may already be running
+  aquireComm();
+  _shm.reset(new ShmTransport(_node_comm, ring));
+  releaseComm();
+  _shm_ready.store(_shm.get(), std::memory_order_release);
+}
+
+void communicator::sendLocal(std::shared_ptr<comm::Message> msg, const int dst) {
+  // the receiver drains the ring without MPI, waiting here can not deadlock with the communicator threads
+  while (!shm()->send(msg, _local_index[dst])) std::this_thread::yield();
+}
+
 void communicator::send(std::shared_ptr<comm::Message> msg, std::size_t to) {
   assert(msg->tag() >= 0 && msg->tag() < registry_names.size());
   const std::string classname = registry_names[msg->tag()];
@@ -94,6 +197,8 @@ void communicator::send(std::shared_ptr<comm::Message> msg, std::size_t to) {
 
   //  std::cout << "Send : " << msg->buffer_size() << " on " << id() << " to " << to
   //            << std::flush << std::endl;
+  countSent(msg);
+  if (isLocal(msg, to)) return sendLocal(msg, to);
   aquireComm();
   MPI_Send(msg->getMessage<void>(), msg->buffer_size(), MPI_BYTE, to, CONTROL_SYSTEM_TAG, MPI_COMM_WORLD);
   releaseComm();
@@ -103,13 +208,14 @@ void communicator::broadcast(std::shared_ptr<comm::Message> msg) {
   const std::string classname = registry_names[msg->tag()];
   assert(registry_ids.find(classname) != registry_ids.end());
   msg->src(id());
+  countSent(msg, lastid() - 1);
   for (int i = 0; i < lastid(); i++) {
     if (i == id()) continue;
-
-    std::shared_ptr<gvt::comm::Message> new_msg = std::make_shared<gvt::comm::Message>(*msg);
-
-    new_msg->dst(i);
-
+    msg->dst(i);
+    if (isLocal(msg, i)) {
+      sendLocal(msg, i);
+      continue;
+    }
     aquireComm();
     MPI_Send(msg->getMessage<void>(), msg->buffer_size(), MPI_BYTE, i, CONTROL_SYSTEM_TAG, MPI_COMM_WORLD);
     releaseComm();
@@ -25,12 +25,16 @@
 #define GVT_CORE_COMMUNICATOR_H
 
 #include <gvt/core/comm/message.h>
+#include <gvt/core/comm/shmtransport.h>
+#include <gvt/core/comm/termination/termination.h>
 #include <gvt/core/comm/vote/vote.h>
 
+#include <atomic>
 #include <memory>
 #include <mutex>
 
 #include <map>
+#include <mpi.h>
 #include <tbb/task_group.h>
 #include <vector>
 
@@ -63,6 +67,7 @@ struct communicator {
   std::vector<std::shared_ptr<Message> > _inbox; /**< Queue of messages received from other nodes waiting to be
                                                     processed by the scheduler*/
   std::shared_ptr<comm::vote::vote> voting;      /**< Voting state pointer for process agreement */
+  std::shared_ptr<comm::termination::termination> _termination; /**< Termination detection message counters */
   std::mutex minbox;                             /**< Inbox mutex */
   std::mutex mvotebooth;
 
@@ -72,6 +77,16 @@ struct communicator {
   std::mutex _mcomm;
   static bool _MPI_THREAD_SERIALIZED;
 
+  // Topology
+  MPI_Comm _node_comm = MPI_COMM_NULL;               /**< Ranks sharing the compute node (MPI_COMM_TYPE_SHARED) */
+  std::vector<int> _leader;                          /**< Node leader (lowest rank in the node) of each rank */
+  std::vector<int> _leaders;                         /**< Node leaders in rank order */
+  std::vector<int> _node_index;                      /**< Index of the node of each rank in _leaders */
+  std::vector<int> _local_index;                     /**< Index of each rank in its node */
+  std::map<int, std::vector<int> > _node_ranks;      /**< Ranks of each node, by leader, in rank order */
+  std::unique_ptr<ShmTransport> _shm;                /**< Node transport (@see enableSharedTransport) */
+  std::atomic<ShmTransport *> _shm_ready{ nullptr }; /**< _shm once created (read by the communication thread) */
+
   /*!
      \brief Get current communicator instance
      \return returns a shared pointer to the instance
@@ -102,6 +117,49 @@ struct communicator {
   */
   std::size_t lastid();
 
+  /*!
+     \brief Children of a rank in the broadcast tree rooted at root
+
+     The tree is topology aware: a binomial tree among compute nodes (the root stands for its node, the node leaders
+     for the other ones), followed by a binomial tree among the ranks of each node. Every message crosses the network
+     once per compute node.
+     \param root Rank that started the broadcast
+     \param rank Rank whose children are returned
+     \param children Children ranks, in the order they should be sent to
+  */
+  void treeChildren(const int root, const int rank, std::vector<int> &children);
+  /*!
+     \brief Parent of a rank in the broadcast tree rooted at root (-1 for the root)
+  */
+  int treeParent(const int root, const int rank);
+  /*!
+     \brief True if both ranks run in the same compute node
+  */
+  bool sameNode(const int a, const int b) { return _leader[a] == _leader[b]; }
+  /*!
+     \brief Rank of the compute node of dst that receives the messages this rank routes through that node
+
+     Every rank of a node uses a different gateway (the rank with the same index in the destination node, modulo its
+     size), so the forwarding load is spread over the ranks of the destination node.
+  */
+  int gateway(const int dst) {
+    const std::vector<int> &ranks = _node_ranks[_leader[dst]];
+    return sameNode(id(), dst) ? dst : ranks[_local_index[id()] % ranks.size()];
+  }
+
+  /*!
+     \brief Create the shared memory transport between the ranks of the compute node
+
+     Collective over all ranks, tracers that send rays among the ranks enable it. The window holds one ring per pair of
+     ranks of the node. GVT_SHM_RING_BYTES sets the ring size (default 2 MiB) and GVT_SHM_TRANSPORT=0 disables the
+     transport. Nothing is created if the node runs a single rank.
+  */
+  void enableSharedTransport();
+  /*!
+     \brief Shared memory transport, nullptr until enableSharedTransport created it
+  */
+  ShmTransport *shm() const { return _shm_ready.load(std::memory_order_acquire); }
+
   /*!
      \brief Send a message buffer to dst compute node
      \param msg Shared pointer to msg description
@@ -112,6 +170,12 @@ struct communicator {
      \brief Send message(msg) to all compute nodes
   */
   virtual void broadcast(std::shared_ptr<comm::Message> msg);
+  /*!
+     \brief Sum value over all compute nodes
+     Collective operation, all nodes must call it in the same order. Blocks the caller until the node finished its part.
+     \return Global sum at root, unspecified on the other nodes
+  */
+  virtual unsigned long reduceSum(const unsigned long value, const int root = 0) = 0;
 
   /*!
      \brief Terminate communicator
@@ -123,6 +187,12 @@ struct communicator {
   */
   virtual void setVote(std::shared_ptr<comm::vote::vote> vote) { voting = vote; }
 
+  /*!
+     \brief Communicator set termination detection procedure
+     The communicator counts the user messages sent and received by the node in the termination detection state.
+  */
+  virtual void setTermination(std::shared_ptr<comm::termination::termination> t) { _termination = t; }
+
   /*!
      \brief Register a message type with the communicator
      The communicator needs a message type identifier to deterime what to do with a message when it is received.
@@ -156,6 +226,35 @@ struct communicator {
   }
 
 protected:
+  friend struct comm::termination::termination;
+  friend struct BufferPool;
+
+  /*!
+     \brief Count a user message sent to another node
+  */
+  void countSent(std::shared_ptr<comm::Message> msg, const std::size_t n = 1) {
+    if (_termination && msg->system_tag() == CONTROL_USER_TAG) _termination->sent(n);
+  }
+  /*!
+     \brief Count a user message received and processed by the node
+  */
+  void countReceived(std::shared_ptr<comm::Message> msg) {
+    if (_termination && msg->system_tag() == CONTROL_USER_TAG) _termination->received();
+  }
+
+  /*!
+     \brief True if the message can be sent to dst through the shared memory transport
+     Only user messages to ranks of the same compute node that fit in a ring, control messages keep using MPI so they
+     are not queued behind ray traffic.
+  */
+  bool isLocal(std::shared_ptr<comm::Message> msg, const int dst) {
+    return shm() && msg->system_tag() == CONTROL_USER_TAG && sameNode(id(), dst) && shm()->fits(*msg);
+  }
+  /*!
+     \brief Send a message to a rank of the same compute node, waiting for space in the ring (@see isLocal)
+  */
+  void sendLocal(std::shared_ptr<comm::Message> msg, const int dst);
+
   /*!
      \brief Constructor
   */
@@ -22,13 +22,21 @@
    ACI-1339881 and ACI-1339840
    ======================================================================================= */
 #include "acomm.h"
+#include <algorithm>
 #include <cassert>
 #include <memory>
 #include <mpi.h>
 
+#include <gvt/core/context/CoreContext.h>
+#include <gvt/core/tracer/tracer.h>
+
 #include <iostream>
 namespace gvt {
 namespace comm {
+
+const int acomm::LANE_MPI_TAG[acomm::NUM_LANES] = { CONTROL_VOTE_TAG, CONTROL_SYSTEM_TAG };
+const std::chrono::microseconds acomm::MAX_BACKOFF(100);
+
 acomm::acomm() {}
 
 void acomm::init(int argc, char *argv[], bool start_thread) {
@@ -70,46 +78,137 @@ void acomm::init(int argc, char *argv[], bool start_thread) {
 
 void acomm::run() {
   std::cout << id() << " Communicator thread started" << std::endl;
+  std::chrono::microseconds backoff(0);
   while (!_terminate) {
-    {
-
-      if (!_outbox.empty()) {
-        std::lock_guard<std::mutex> l(moutbox);
-        std::shared_ptr<Message> msg = _outbox.front();
-        _outbox.erase(_outbox.begin());
-        aquireComm();
-        MPI_Send(msg->getMessage<void>(), msg->buffer_size(), MPI::BYTE, msg->dst(), CONTROL_SYSTEM_TAG,
-                 MPI_COMM_WORLD);
-        releaseComm();
-      }
-
-      MPI_Status status;
-      memset(&status, 0, sizeof(MPI_Status));
-      int flag;
-      aquireComm();
-      MPI_Iprobe(MPI_ANY_SOURCE, CONTROL_SYSTEM_TAG, MPI_COMM_WORLD, &flag, &status);
-      releaseComm();
-      int n_bytes = 0;
-      MPI_Get_count(&status, MPI_BYTE, &n_bytes);
-
-      if (n_bytes > 0) {
-        int sender = status.MPI_SOURCE;
-        const auto data_size = n_bytes - sizeof(Message::header);
-        std::shared_ptr<Message> msg = std::make_shared<Message>(data_size);
-
-        //        std::cout << "Recv : " << n_bytes << " on " << id() << " from " << sender
-        //                  << std::flush << std::endl;
-        aquireComm();
-        MPI_Recv(msg->getMessage<void>(), n_bytes, MPI_BYTE, sender, CONTROL_SYSTEM_TAG, MPI_COMM_WORLD,
-                 MPI_STATUS_IGNORE);
-        releaseComm();
-        msg->size(data_size);
-        std::lock_guard<std::mutex> l(minbox);
-        if (msg->system_tag() == CONTROL_USER_TAG) _inbox.push_back(msg);
-        if (msg->system_tag() == CONTROL_VOTE_TAG) voting->processMessage(msg);
-      }
+    _pending = false;
+    std::size_t events = 0;
+    // control lane first, votes must not wait behind ray traffic
+    for (int l = CONTROL_LANE; l < NUM_LANES; l++) {
+      events += completeSends(lane(l));
+      events += progressRecvs(lane(l));
+      events += progressSends(lane(l));
     }
+    events += progressLocal();
+    if (events > 0) {
+      backoff = std::chrono::microseconds(0);
+      continue;
+    }
+
+    // Nothing happened, sleep until a message is queued or the backoff expires (incoming messages can only be polled)
+    backoff = std::min(MAX_BACKOFF, std::max(std::chrono::microseconds(1), backoff * 2));
+    std::unique_lock<std::mutex> l(mwake);
+    _sleeping = true;
+    _wake.wait_for(l, backoff, [&]() { return _pending.load() || _terminate; });
+    _sleeping = false;
+  }
+
+  // Let MPI complete the remaining sends on its own, the buffers stay alive in _sending with the communicator
+  for (int l = CONTROL_LANE; l < NUM_LANES; l++) {
+    completeSends(lane(l));
+    for (auto &r : _requests[l]) MPI_Request_free(&r);
+    _requests[l].clear();
+  }
+}
+
+void acomm::post(std::shared_ptr<Message> msg, const int dst) {
+  _outbox[laneOf(msg)].push(outgoing{ msg, dst });
+  _pending = true;
+  if (_sleeping) {
+    std::lock_guard<std::mutex> l(mwake);
+    _wake.notify_one();
+  }
+}
+
+std::size_t acomm::progressSends(const lane l) {
+  std::size_t n = 0;
+  outgoing o;
+  while ((l == CONTROL_LANE || _requests[l].size() < MAX_INFLIGHT) && _outbox[l].try_pop(o)) {
+    n++;
+    // if the ring is full the message goes through MPI, the engine never waits
+    if (isLocal(o.msg, o.dst) && shm()->send(o.msg, _local_index[o.dst])) continue;
+    MPI_Request request;
+    aquireComm();
+    MPI_Isend(o.msg->getMessage<void>(), o.msg->buffer_size(), MPI_BYTE, o.dst, LANE_MPI_TAG[l], MPI_COMM_WORLD,
+              &request);
+    releaseComm();
+    _requests[l].push_back(request);
+    _sending[l].push_back(o.msg);
+  }
+  return n;
+}
+
+std::size_t acomm::completeSends(const lane l) {
+  if (_requests[l].empty()) return 0;
+  std::vector<int> done(_requests[l].size());
+  int count = 0;
+  aquireComm();
+  MPI_Testsome(_requests[l].size(), &_requests[l][0], &count, &done[0], MPI_STATUSES_IGNORE);
+  releaseComm();
+  if (count <= 0) return 0;
+
+  // compact the requests still in flight
+  std::size_t k = 0;
+  for (std::size_t i = 0; i < _requests[l].size(); i++) {
+    if (_requests[l][i] == MPI_REQUEST_NULL) continue;
+    _requests[l][k] = _requests[l][i];
+    std::swap(_sending[l][k], _sending[l][i]);
+    k++;
+  }
+  _requests[l].resize(k);
+  _sending[l].resize(k);
+  return count;
+}
+
+std::size_t acomm::progressRecvs(const lane l) {
+  std::size_t n = 0;
+  for (; n < MAX_RECV_BURST; n++) {
+    int flag = 0;
+    MPI_Message handle;
+    MPI_Status status;
+    aquireComm();
+    MPI_Improbe(MPI_ANY_SOURCE, LANE_MPI_TAG[l], MPI_COMM_WORLD, &flag, &handle, &status);
+    releaseComm();
+    if (!flag) break;
+
+    int n_bytes = 0;
+    MPI_Get_count(&status, MPI_BYTE, &n_bytes);
+    const auto data_size = n_bytes - sizeof(Message::header);
+    std::shared_ptr<Message> msg = std::make_shared<Message>(data_size);
+    aquireComm();
+    MPI_Mrecv(msg->getMessage<void>(), n_bytes, MPI_BYTE, &handle, MPI_STATUS_IGNORE);
+    releaseComm();
+    msg->size(data_size);
+    dispatch(msg);
+  }
+  return n;
+}
+
+std::size_t acomm::progressLocal() {
+  ShmTransport *local = shm();
+  if (!local) return 0;
+  std::size_t n = 0;
+  for (; n < MAX_RECV_BURST; n++) {
+    std::shared_ptr<Message> msg = local->recv();
+    if (!msg) break;
+    dispatch(msg);
+  }
+  return n;
+}
+
+void acomm::dispatch(std::shared_ptr<Message> msg) {
+  // forward a copy, the handlers may modify the message buffer in place
+  if (msg->dst() == Message::BROADCAST) forward(std::make_shared<Message>(*msg));
+  if (msg->system_tag() == CONTROL_REDUCE_TAG) {
+    reduce(msg);
+    return;
+  }
+  std::lock_guard<std::mutex> l(minbox);
+  if (msg->system_tag() == CONTROL_USER_TAG) {
+    gvt::core::CoreContext &cntxt = *gvt::core::CoreContext::instance();
+    cntxt.tracer()->MessageManager(msg);
+    countReceived(msg);
   }
+  if (msg->system_tag() == CONTROL_VOTE_TAG) voting->processMessage(msg);
 }
 
 void acomm::send(std::shared_ptr<comm::Message> msg, std::size_t to) {
@@ -118,8 +217,8 @@ void acomm::send(std::shared_ptr<comm::Message> msg, std::size_t to) {
   assert(registry_ids.find(classname) != registry_ids.end());
   msg->src(id());
   msg->dst(to);
-  std::lock_guard<std::mutex> l(moutbox);
-  _outbox.push_back(msg);
+  countSent(msg);
+  post(msg, to);
 };
 
 void acomm::broadcast(std::shared_ptr<comm::Message> msg) {
@@ -127,14 +226,77 @@ void acomm::broadcast(std::shared_ptr<comm::Message> msg) {
   const std::string classname = registry_names[msg->tag()];
   assert(registry_ids.find(classname) != registry_ids.end());
   msg->src(id());
-  for (int i = 0; i < lastid(); i++) {
-    if (i == id()) continue;
-    std::shared_ptr<gvt::comm::Message> new_msg = std::make_shared<gvt::comm::Message>(*msg);
+  msg->dst(Message::BROADCAST);
+  countSent(msg, lastid() - 1);
+  forward(msg);
+};
+
+void acomm::forward(std::shared_ptr<Message> msg) {
+  std::vector<int> children;
+  treeChildren(msg->src(), id(), children);
+  for (const int c : children) post(msg, c);
+}
+
+std::shared_ptr<acomm::reduction> acomm::ireduce(std::shared_ptr<Message> contribution, const int root,
+                                                 reduce_op op) {
+  std::lock_guard<std::mutex> l(mreduce);
+  const std::size_t seq = _reduce_seq++;
+  std::shared_ptr<reduction> &r = _reductions[seq];
+  if (!r) r = std::make_shared<reduction>();
+  std::vector<int> children;
+  treeChildren(root, id(), children);
+  r->acc = contribution;
+  r->op = op;
+  r->root = root;
+  r->expected = children.size();
+  r->contributed = true;
+  for (auto &m : r->early) r->op(*r->acc, *m);
+  r->received = r->early.size();
+  r->early.clear();
+  std::shared_ptr<reduction> ret = r;
+  advance(seq, ret);
+  return ret;
+}
+
+unsigned long acomm::reduceSum(const unsigned long value, const int root) {
+  std::shared_ptr<Message> msg = std::make_shared<Message>(sizeof(unsigned long));
+  *msg->getMessage<unsigned long>() = value;
+  std::shared_ptr<reduction> r = ireduce(msg, root, [](Message &acc, Message &in) {
+    *acc.getMessage<unsigned long>() += *in.getMessage<unsigned long>();
+  });
+  std::unique_lock<std::mutex> l(mreduce);
+  _reduced.wait(l, [&] { return r->done.load(); });
+  return *r->acc->getMessage<unsigned long>();
+}
 
-    new_msg->dst(i);
-    std::lock_guard<std::mutex> l(moutbox);
-    _outbox.push_back(new_msg);
+void acomm::reduce(std::shared_ptr<Message> msg) {
+  std::lock_guard<std::mutex> l(mreduce);
+  std::shared_ptr<reduction> &r = _reductions[msg->seq()];
+  if (!r) r = std::make_shared<reduction>();
+  if (!r->contributed) {
+    r->early.push_back(msg);
+    return;
   }
-};
+  r->op(*r->acc, *msg);
+  r->received++;
+  std::shared_ptr<reduction> keep = r;
+  advance(msg->seq(), keep);
+}
+
+void acomm::advance(const std::size_t seq, std::shared_ptr<reduction> r) {
+  if (!r->contributed || r->received < r->expected) return;
+  _reductions.erase(seq);
+  if (r->root != id()) {
+    std::shared_ptr<Message> partial = r->acc;
+    partial->system_tag(CONTROL_REDUCE_TAG);
+    partial->seq(seq);
+    partial->src(id());
+    const int parent = treeParent(r->root, id());
+    partial->dst(parent);
+    post(partial, parent);
+  }
+  r->done = true;
+  _reduced.notify_all();
+}
 }
 }
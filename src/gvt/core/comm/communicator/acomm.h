@@ -26,6 +26,14 @@
 
 #include <gvt/core/comm/communicator.h>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mpi.h>
+#include <tbb/concurrent_queue.h>
+
 namespace gvt {
 namespace comm {
     /**
@@ -34,9 +42,26 @@ namespace comm {
      * This communicator assumes that all message passing is done asynchronously. If a compute threads sends a message
      * the message is placed in a queue to be sent later by the resident communication threads and a handler is return to
      * the calling control flow so that we can determine is the message was already sent or not.
+     *
+     * The resident thread is a progress engine: outgoing messages are taken from lock-free outboxes and posted with
+     * MPI_Isend (at most MAX_INFLIGHT bulk sends at a time), incoming messages are matched with MPI_Improbe and received
+     * with MPI_Mrecv directly into pooled buffers. Control messages (votes) travel in their own lane, with their own MPI
+     * tag, and are always sent and received before bulk (ray) data. When there is nothing to do the thread backs off
+     * and sleeps until a new message is queued or the backoff expires. Bulk messages for ranks of the same compute node
+ * are written to the shared memory transport (@see ShmTransport) instead of MPI.
      *
      */
 struct acomm : public communicator {
+  /**
+   * @brief Message lanes, lower values have higher priority
+   */
+  enum lane { CONTROL_LANE = 0, BULK_LANE, NUM_LANES };
+
+  static const int LANE_MPI_TAG[NUM_LANES];           /**< MPI tag used by each lane */
+  static const std::size_t MAX_INFLIGHT = 64;         /**< Maximum number of bulk sends in flight */
+  static const std::size_t MAX_RECV_BURST = 32;       /**< Maximum messages received per lane and iteration */
+  static const std::chrono::microseconds MAX_BACKOFF; /**< Maximum idle sleep of the progress engine */
+
   acomm();
   /**
    * Communicator singleton initialization
@@ -53,16 +78,127 @@ struct acomm : public communicator {
   virtual void send(std::shared_ptr<comm::Message> msg, std::size_t id);
   /**
    * Send msg to all compute nodes
+   *
+   * The message travels down the topology aware broadcast tree (@see communicator::treeChildren): the caller only
+   * sends to its children and every node forwards the message to its own children when it receives it, so each
+   * node sends O(log P) messages and each message crosses the network once per compute node.
+   *
    * @param msg Message to be sent
    */
   virtual void broadcast(std::shared_ptr<comm::Message> msg);
+
+  /**
+   * \brief Reduction operator, combines a partial result (in) into the accumulated result (acc)
+   */
+  typedef std::function<void(Message &acc, Message &in)> reduce_op;
+
+  /**
+   * \brief State of a non-blocking reduction
+   */
+  struct reduction {
+    std::shared_ptr<Message> acc;                    /**< Accumulated result (the result at the root) */
+    reduce_op op;                                    /**< Reduction operator */
+    int root = 0;                                    /**< Rank that receives the result */
+    std::size_t expected = 0;                        /**< Number of children in the reduction tree */
+    std::size_t received = 0;                        /**< Number of children results combined */
+    bool contributed = false;                        /**< True once the local node contributed */
+    std::vector<std::shared_ptr<Message> > early;    /**< Children results received before the local contribution */
+    std::atomic<bool> done{ false };                 /**< True when the node finished its part of the reduction */
+  };
+
+  /**
+   * \brief Non-blocking reduction of small control payloads
+   *
+   * Collective operation, all nodes must invoke the reductions in the same order. Partial results travel up the
+   * broadcast tree rooted at root in the control lane, each node combines its children results with its own
+   * contribution before it forwards it to its parent. The contribution message must not be used by the caller
+   * after the call.
+   *
+   * @param contribution Node contribution, it holds the final result at the root
+   * @param root         Rank that receives the result
+   * @param op           Reduction operator
+   * @return Reduction state, done becomes true when the node finished (at the root, when acc holds the result)
+   */
+  std::shared_ptr<reduction> ireduce(std::shared_ptr<Message> contribution, const int root, reduce_op op);
+  /**
+   * \brief Sum value over all compute nodes through ireduce, the caller sleeps until the reduction is done
+   */
+  virtual unsigned long reduceSum(const unsigned long value, const int root = 0);
   /**
    * Method execute by the resident communication thread
    */
   virtual void run();
 
-  std::vector<std::shared_ptr<Message> > _outbox; /**< Outbox message queue */
-  std::mutex moutbox; /** Outbox protection mutex */
+  /**
+   * @brief Message waiting in the outbox
+   */
+  struct outgoing {
+    std::shared_ptr<Message> msg; /**< Message to be sent */
+    int dst;                      /**< Destination compute node id */
+  };
+
+  tbb::concurrent_queue<outgoing> _outbox[NUM_LANES];         /**< Outbox message queues (lock-free) */
+  std::vector<MPI_Request> _requests[NUM_LANES];              /**< Sends in flight (communication thread only) */
+  std::vector<std::shared_ptr<Message> > _sending[NUM_LANES]; /**< Messages held until their send completes */
+
+  std::mutex mwake;                     /**< Progress engine wake up mutex */
+  std::condition_variable _wake;        /**< Signaled when a message is queued while the engine sleeps */
+  std::atomic<bool> _pending{ false };  /**< True if messages were queued since the engine last looked */
+  std::atomic<bool> _sleeping{ false }; /**< True while the engine waits on _wake */
+
+  std::mutex mreduce;                                          /**< Reductions protection */
+  std::map<std::size_t, std::shared_ptr<reduction> > _reductions; /**< Reductions in progress by sequence number */
+  std::size_t _reduce_seq = 0;                                  /**< Sequence number of the next reduction */
+  std::condition_variable _reduced;                             /**< Signaled when a reduction is done */
+
+protected:
+  /**
+   * @brief Lane a message travels in
+   */
+  static lane laneOf(std::shared_ptr<Message> &msg) {
+    return (msg->system_tag() == CONTROL_USER_TAG) ? BULK_LANE : CONTROL_LANE;
+  }
+  /**
+   * @brief Queue a message and wake the progress engine
+   */
+  void post(std::shared_ptr<Message> msg, const int dst);
+  /**
+   * @brief Post queued messages of a lane with MPI_Isend
+   * @return number of messages posted
+   */
+  std::size_t progressSends(const lane l);
+  /**
+   * @brief Complete sends of a lane
+   * @return number of sends completed
+   */
+  std::size_t completeSends(const lane l);
+  /**
+   * @brief Receive and dispatch available messages of a lane
+   * @return number of messages received
+   */
+  std::size_t progressRecvs(const lane l);
+  /**
+   * @brief Receive the messages sent through shared memory by ranks of the same compute node
+   */
+  std::size_t progressLocal();
+  /**
+   * @brief Deliver a received message to the tracer, the vote or the reductions
+   *
+   * Broadcast messages are forwarded to the children of the node in the broadcast tree first.
+   */
+  void dispatch(std::shared_ptr<Message> msg);
+  /**
+   * @brief Send a broadcast message to the children of the node in the broadcast tree
+   */
+  void forward(std::shared_ptr<Message> msg);
+  /**
+   * @brief Combine a child partial result into a reduction
+   */
+  void reduce(std::shared_ptr<Message> msg);
+  /**
+   * @brief Complete the node part of a reduction if all results were combined, the caller must hold mreduce
+   */
+  void advance(const std::size_t seq, std::shared_ptr<reduction> r);
 };
 }
 }
@@ -100,17 +100,37 @@ void scomm::run() {
         releaseComm();
 
         msg->size(data_size);
-        std::lock_guard<std::mutex> l(minbox);
-        if (msg->system_tag() == CONTROL_USER_TAG) {
-          gvt::core::CoreContext &cntxt = *gvt::core::CoreContext::instance();
-          cntxt.tracer()->MessageManager(msg);
-
-          //        	_inbox.push_back(msg);
-        }
-        if (msg->system_tag() == CONTROL_VOTE_TAG) voting->processMessage(msg);
+        dispatch(msg);
       }
     }
+    if (ShmTransport *local = shm()) {
+      for (int i = 0; i < local->size(); i++) {
+        std::shared_ptr<Message> msg = local->recv();
+        if (!msg) break;
+        dispatch(msg);
+      }
+    }
+  }
+}
+
+unsigned long scomm::reduceSum(const unsigned long value, const int root) {
+  unsigned long global = 0;
+  aquireComm();
+  MPI_Reduce(&value, &global, 1, MPI_UNSIGNED_LONG, MPI_SUM, root, MPI_COMM_WORLD);
+  releaseComm();
+  return global;
+}
+
+void scomm::dispatch(std::shared_ptr<Message> msg) {
+  std::lock_guard<std::mutex> l(minbox);
+  if (msg->system_tag() == CONTROL_USER_TAG) {
+    gvt::core::CoreContext &cntxt = *gvt::core::CoreContext::instance();
+    cntxt.tracer()->MessageManager(msg);
+    countReceived(msg);
+
+    //        	_inbox.push_back(msg);
   }
+  if (msg->system_tag() == CONTROL_VOTE_TAG) voting->processMessage(msg);
 }
 }
 }
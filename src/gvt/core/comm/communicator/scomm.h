@@ -55,6 +55,16 @@ struct scomm : communicator {
    * Method execute by the resident communication thread
    */
   virtual void run();
+  /**
+   * Sum value over all compute nodes with MPI_Reduce
+   */
+  virtual unsigned long reduceSum(const unsigned long value, const int root = 0);
+
+protected:
+  /**
+   * Deliver a received message to the tracer or to the vote
+   */
+  void dispatch(std::shared_ptr<Message> msg);
 };
 }
 }
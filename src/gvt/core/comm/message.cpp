@@ -24,6 +24,7 @@
 #include <gvt/core/comm/communicator.h>
 #include <gvt/core/comm/message.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstring>
@@ -37,21 +38,20 @@ namespace gvt {
 
 namespace comm {
 
+const long Message::BROADCAST;
+
 Message::Message(const std::size_t &s) {
   _buffer_size = s + sizeof(header);
-  content = static_cast<Byte *>(std::malloc(_buffer_size));
+  content = BufferPool::instance().acquire(_buffer_size);
+  new (&getHeader()) header();
   tag(COMMUNICATOR_MESSAGE_TAG);
   system_tag(CONTROL_USER_TAG);
   size(s);
 }
 
 Message::Message(const Message &msg) {
-  if (_buffer_size > 0) {
-    content = static_cast<Byte *>(std::realloc(content, msg.buffer_size()));
-  } else {
-    content = static_cast<Byte *>(std::malloc(msg.buffer_size()));
-  }
   _buffer_size = msg.buffer_size();
+  content = BufferPool::instance().acquire(_buffer_size);
   std::memcpy(content, msg.content, msg.buffer_size());
 }
 
@@ -60,7 +60,22 @@ Message::Message(Message &&msg) {
   std::swap(_buffer_size, msg._buffer_size);
 }
 
-Message::~Message() { std::free(content); }
+Message::~Message() { BufferPool::instance().release(content); }
+
+void Message::resize(const std::size_t s) {
+  const header h = getHeader();
+  const std::size_t keep = std::min(s, h.USER_MSG_SIZE);
+  const std::size_t bs = s + sizeof(header);
+  if (bs > BufferPool::capacity(content)) {
+    Byte *buf = BufferPool::instance().acquire(bs);
+    std::memcpy(buf, content, keep);
+    BufferPool::instance().release(content);
+    content = buf;
+  }
+  _buffer_size = bs;
+  std::memcpy(content + s, &h, sizeof(header));
+  size(s);
+}
 
 Message::header &Message::getHeader() { return *reinterpret_cast<header *>(content + (_buffer_size - sizeof(header))); }
 std::size_t Message::tag() { return getHeader().USER_TAG; };
@@ -30,6 +30,8 @@
 #include <cstring>
 #include <memory>
 
+#include <gvt/core/comm/bufferpool.h>
+
 /**
  *  \brief Communication message definiton
  *
@@ -43,7 +45,8 @@ namespace comm {
 enum SYSTEM_COMM_TAG {
   CONTROL_SYSTEM_TAG = 0x8 /**< Used internally by the raytracing framework*/,
   CONTROL_USER_TAG /**< Developer level message */,
-  CONTROL_VOTE_TAG /**< Voting message */
+  CONTROL_VOTE_TAG /**< Voting message */,
+  CONTROL_REDUCE_TAG /**< Partial result of a reduction */
 };
 
 /**
@@ -63,6 +66,10 @@ enum SYSTEM_COMM_TAG {
 
 /**
  * \brief Abstract Communication Message
+ *
+ * The message buffer (user content followed by the header) is taken from the communication BufferPool and returned
+ * to it when the message is destroyed. Senders should build the content in place (see resize and getMessage) and
+ * receivers may use the content directly while they hold the message, avoiding copies of large payloads.
  */
 struct Message {
 
@@ -77,10 +84,13 @@ struct Message {
     std::size_t USER_TAG;                      /**< Message identifer at user level */
     std::size_t SYSTEM_TAG = CONTROL_USER_TAG; /**< System tag indentifier (By default always at user level) */
     std::size_t USER_MSG_SIZE;                 /**< Size of the buffer to be sent as defined by the user */
-    long dst;                                  /**< Compute node id destination */
+    long dst;                                  /**< Compute node id destination (BROADCAST if sent to all nodes) */
     long src;                                  /**< Compute node ID origin */
+    std::size_t SEQ;                           /**< Collective operation sequence number */
   };
 
+  static const long BROADCAST = -1; /**< Destination of messages sent to all compute nodes */
+
   /**
    * \brief Create a message with buffer size
    * @param size Size of the buffer in bytes
@@ -176,6 +186,15 @@ struct Message {
    */
   void src(long s) { getHeader().src = s; }
 
+  /**
+   * Collective operation sequence number
+   */
+  std::size_t &seq() { return getHeader().SEQ; }
+  /**
+   * Set collective operation sequence number
+   */
+  void seq(std::size_t s) { getHeader().SEQ = s; }
+
   /**
    * Returns the message content as a buffer of type T
    * @return pointer to buffer of type T
@@ -187,19 +206,17 @@ struct Message {
    * @param os   Number of elements of type T in the buffer
    */
   template <typename T> void setMessage(T *orig, const std::size_t &os) {
-    header &mhi = getHeader();
-    std::size_t bs = sizeof(T) * os;
-    if (_buffer_size > 0) {
-      content = static_cast<Byte *>(std::realloc(content, bs + sizeof(header)));
-    } else {
-      content = static_cast<Byte *>(std::malloc(bs + sizeof(header)));
-    }
-    _buffer_size = bs + sizeof(header);
-    std::memcpy(content, orig, bs);
-    std::memcpy(content + bs, &mhi, sizeof(header));
-    size(bs);
+    resize(sizeof(T) * os);
+    std::memcpy(content, orig, sizeof(T) * os);
   }
 
+  /**
+   * Resize the message content keeping the header. The buffer is only reallocated if the new size exceeds its
+   * capacity, the content is preserved up to the smaller size.
+   * @param size Size of the content in bytes
+   */
+  void resize(const std::size_t size);
+
 protected:
   std::size_t _buffer_size = 0;
   Byte *content = nullptr;
@@ -0,0 +1,124 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+#include <gvt/core/comm/shmtransport.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <new>
+
+namespace gvt {
+namespace comm {
+
+namespace {
+std::uint64_t record(const std::size_t n) {
+  return (sizeof(std::uint64_t) + n + ShmTransport::CACHE_LINE - 1) & ~std::uint64_t(ShmTransport::CACHE_LINE - 1);
+}
+}
+
+ShmTransport::ShmTransport(MPI_Comm node_comm, std::size_t ringBytes) {
+  MPI_Comm_rank(node_comm, &_rank);
+  MPI_Comm_size(node_comm, &_size);
+
+  // every rank of the node must lay out the rings the same way
+  unsigned long long bytes = ringBytes;
+  MPI_Bcast(&bytes, 1, MPI_UNSIGNED_LONG_LONG, 0, node_comm);
+  _ringBytes = (std::max<std::size_t>(bytes, CACHE_LINE) + CACHE_LINE - 1) & ~(CACHE_LINE - 1);
+  _stride = sizeof(ring) + _ringBytes;
+
+  Byte *mine = nullptr;
+  MPI_Win_allocate_shared(_stride * _size, 1, MPI_INFO_NULL, node_comm, &mine, &_win);
+  _rings.resize(_size);
+  _rings[_rank] = mine;
+  for (int s = 0; s < _size; s++) {
+    new (&inbound(s)->head) std::atomic<std::uint64_t>(0);
+    new (&inbound(s)->tail) std::atomic<std::uint64_t>(0);
+  }
+
+  for (int r = 0; r < _size; r++) {
+    MPI_Aint size;
+    int disp;
+    MPI_Win_shared_query(_win, r, &size, &disp, &_rings[r]);
+  }
+  _mring.reset(new std::mutex[_size]);
+  MPI_Barrier(node_comm);
+}
+
+ShmTransport::~ShmTransport() {
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (!finalized && _win != MPI_WIN_NULL) MPI_Win_free(&_win);
+}
+
+bool ShmTransport::fits(Message &msg) const { return record(msg.buffer_size()) <= _ringBytes; }
+
+bool ShmTransport::send(std::shared_ptr<Message> msg, const int dst) {
+  assert(dst >= 0 && dst < _size && dst != _rank);
+  const std::size_t n = msg->buffer_size();
+  const std::uint64_t need = record(n);
+  if (need > _ringBytes) return false;
+
+  std::lock_guard<std::mutex> l(_mring[dst]);
+  ring &r = *outbound(dst);
+  std::uint64_t tail = r.tail.load(std::memory_order_relaxed);
+  const std::uint64_t pos = tail % _ringBytes;
+  const std::uint64_t skip = (_ringBytes - pos < need) ? _ringBytes - pos : 0;
+  if (tail + skip + need - r.head.load(std::memory_order_acquire) > _ringBytes) return false;
+
+  if (skip) {
+    *reinterpret_cast<std::uint64_t *>(data(r) + pos) = WRAP;
+    tail += skip;
+  }
+  Byte *rec = data(r) + tail % _ringBytes;
+  *reinterpret_cast<std::uint64_t *>(rec) = n;
+  std::memcpy(rec + sizeof(std::uint64_t), msg->getMessage<void>(), n);
+  r.tail.store(tail + need, std::memory_order_release);
+  return true;
+}
+
+std::shared_ptr<Message> ShmTransport::recv() {
+  for (int i = 0; i < _size; i++) {
+    const int src = (_next + i) % _size;
+    if (src == _rank) continue;
+    ring &r = *inbound(src);
+    std::uint64_t head = r.head.load(std::memory_order_relaxed);
+    if (head == r.tail.load(std::memory_order_acquire)) continue;
+
+    std::uint64_t pos = head % _ringBytes;
+    std::uint64_t n = *reinterpret_cast<std::uint64_t *>(data(r) + pos);
+    if (n == WRAP) {
+      head += _ringBytes - pos;
+      pos = 0;
+      n = *reinterpret_cast<std::uint64_t *>(data(r));
+    }
+    std::shared_ptr<Message> msg = std::make_shared<Message>(n - sizeof(Message::header));
+    std::memcpy(msg->getMessage<void>(), data(r) + pos + sizeof(std::uint64_t), n);
+    r.head.store(head + record(n), std::memory_order_release);
+    _next = src + 1;
+    return msg;
+  }
+  return nullptr;
+}
+}
+}
@@ -0,0 +1,121 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+#ifndef GVT_CORE_SHM_TRANSPORT_H
+#define GVT_CORE_SHM_TRANSPORT_H
+
+#include <gvt/core/comm/message.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mpi.h>
+#include <mutex>
+#include <vector>
+
+namespace gvt {
+namespace comm {
+
+/**
+ * @brief Intra-node message transport
+ *
+ * Ranks in the same compute node exchange messages through a MPI-3 shared memory window instead of MPI point to point.
+ * Every rank owns one single producer / single consumer ring per rank of its node (the senders) in the window, the
+ * sender writes the message buffer directly into the receiver ring and the receiver reads it into a pooled message, so
+ * a message is copied once on each side and never goes through the MPI matching and protocol layers.
+ *
+ * Messages that do not fit in the free space of the ring are refused (send returns false), the caller either retries
+ * or falls back to MPI.
+ */
+struct ShmTransport {
+  typedef unsigned char Byte;
+
+  static const std::size_t CACHE_LINE = 64;              /**< Ring record alignment */
+  static const std::size_t DEFAULT_RING_BYTES = 2 << 20; /**< Default data capacity of each ring */
+  static const std::uint64_t WRAP = ~std::uint64_t(0);   /**< Record marker, the ring continues at its beginning */
+
+  /**
+   * @brief Create the shared window (collective over node_comm)
+   *
+   * The window holds one ring per pair of node ranks, n^2 rings per node. The ring size of the first rank of the node
+   * is used by all of them.
+   *
+   * @param node_comm Communicator of the ranks sharing the compute node
+   * @param ringBytes Data capacity of each ring (rounded up to CACHE_LINE)
+   */
+  ShmTransport(MPI_Comm node_comm, std::size_t ringBytes = DEFAULT_RING_BYTES);
+  /**
+   * @brief Free the shared window (collective over the node ranks)
+   */
+  ~ShmTransport();
+
+  /**
+   * @brief True if the message fits in an empty ring
+   */
+  bool fits(Message &msg) const;
+  /**
+   * @brief Copy the message into the ring of the local rank dst
+   * @param msg Message to send
+   * @param dst Destination index in the node communicator
+   * @return false if the ring has not enough free space (nothing is sent)
+   */
+  bool send(std::shared_ptr<Message> msg, const int dst);
+  /**
+   * @brief Receive the next message from any local rank (communication thread only)
+   * @return Received message or nullptr if all rings are empty
+   */
+  std::shared_ptr<Message> recv();
+
+  /**
+   * @brief Number of ranks in the node
+   */
+  int size() const { return _size; }
+
+protected:
+  /**
+   * @brief Ring control block, head and tail are byte counters that never wrap. The ring data follows the block.
+   */
+  struct ring {
+    alignas(CACHE_LINE) std::atomic<std::uint64_t> head; /**< Consumed bytes (written by the receiver) */
+    alignas(CACHE_LINE) std::atomic<std::uint64_t> tail; /**< Produced bytes (written by the sender) */
+  };
+
+  ring *at(const int owner, const int src) { return reinterpret_cast<ring *>(_rings[owner] + src * _stride); }
+  ring *inbound(const int src) { return at(_rank, src); }
+  ring *outbound(const int dst) { return at(dst, _rank); }
+  static Byte *data(ring &r) { return reinterpret_cast<Byte *>(&r) + sizeof(ring); }
+
+  MPI_Win _win = MPI_WIN_NULL;
+  std::size_t _ringBytes = DEFAULT_RING_BYTES; /**< Data capacity of each ring */
+  std::size_t _stride = 0;                     /**< Bytes between consecutive rings (control block and data) */
+  int _rank = 0;                         /**< Rank in the node */
+  int _size = 1;                         /**< Ranks in the node */
+  int _next = 0;                         /**< Next ring to poll (round robin) */
+  std::vector<Byte *> _rings;            /**< Rings of each rank in the node, indexed by sender */
+  std::unique_ptr<std::mutex[]> _mring; /**< Serializes the local senders of each outbound ring */
+};
+}
+}
+
+#endif /* GVT_CORE_SHM_TRANSPORT_H */
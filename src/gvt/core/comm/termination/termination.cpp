@@ -0,0 +1,79 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+#include <gvt/core/comm/communicator.h>
+#include <gvt/core/comm/termination/termination.h>
+
+namespace gvt {
+namespace comm {
+namespace termination {
+
+termination::termination() : _sent(0), _received(0) {
+  communicator &comm = communicator::instance();
+  comm.aquireComm();
+  MPI_Comm_dup(MPI_COMM_WORLD, &_comm);
+  comm.releaseComm();
+}
+
+termination::~termination() {
+  int finalized = 0;
+  MPI_Finalized(&finalized);
+  if (finalized) return;
+  // nonblocking collectives can not be cancelled, every rank posts the same reductions so the last one completes
+  if (_request != MPI_REQUEST_NULL) MPI_Wait(&_request, MPI_STATUS_IGNORE);
+  if (_comm != MPI_COMM_NULL) MPI_Comm_free(&_comm);
+}
+
+bool termination::progress(const bool idle) {
+  communicator &comm = communicator::instance();
+  if (comm.lastid() == 1) return idle;
+
+  if (_request == MPI_REQUEST_NULL) {
+    if (!idle) return false;
+    _local[0] = _sent;
+    _local[1] = _received;
+    comm.aquireComm();
+    MPI_Iallreduce(_local, _global, 2, MPI_UNSIGNED_LONG, MPI_SUM, _comm, &_request);
+    comm.releaseComm();
+    return false;
+  }
+
+  int flag = 0;
+  comm.aquireComm();
+  MPI_Test(&_request, &flag, MPI_STATUS_IGNORE);
+  comm.releaseComm();
+  if (!flag) return false;
+
+  const bool done = _has_previous && _global[0] == _global[1] && _previous[0] == _global[0] &&
+                    _previous[1] == _global[1];
+  _previous[0] = _global[0];
+  _previous[1] = _global[1];
+  _has_previous = true;
+  if (done) reset();
+  return done;
+}
+
+void termination::reset() { _has_previous = false; }
+}
+}
+}
@@ -0,0 +1,105 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+#ifndef TERMINATION_H
+#define TERMINATION_H
+
+#include <atomic>
+#include <mpi.h>
+
+namespace gvt {
+namespace comm {
+namespace termination {
+
+/**
+ * @brief Distributed termination detection
+ *
+ * Message counting termination detection (four counter method). Each node counts the user messages it sent and the
+ * user messages it received and processed. When a node is idle it contributes its counters to a non-blocking
+ * all-reduce (a wave) and keeps working while the wave completes in the background. The computation is terminated when
+ * two consecutive waves report the same totals and the total number of messages sent equals the total number of
+ * messages received, i.e. no message was in flight and no node received work between the two waves.
+ *
+ * There is no coordinator node and the nodes never block on a collective operation. All nodes detect termination
+ * on the same wave.
+ */
+struct termination {
+
+  std::atomic<unsigned long> _sent;     /**< Number of user messages sent by the node */
+  std::atomic<unsigned long> _received; /**< Number of user messages received and processed by the node */
+
+  MPI_Comm _comm = MPI_COMM_NULL;          /**< Private communicator used by the waves */
+  MPI_Request _request = MPI_REQUEST_NULL; /**< Current wave request (MPI_REQUEST_NULL if no wave is active) */
+  unsigned long _local[2];                 /**< Node counters (sent, received) contributed to the current wave */
+  unsigned long _global[2];                /**< Total counters (sent, received) of the current wave */
+  unsigned long _previous[2];              /**< Total counters (sent, received) of the last completed wave */
+  bool _has_previous = false;              /**< True if a wave was completed since the last termination */
+
+  /**
+   * @brief Constructor
+   *
+   * Collective operation, must be invoked by all nodes.
+   */
+  termination();
+  ~termination();
+
+  /**
+   * @brief Count user messages sent by the node
+   * @param n Number of messages
+   */
+  void sent(const unsigned long n = 1) { _sent += n; }
+
+  /**
+   * @brief Count user messages received by the node
+   *
+   * Must be invoked only after the message was processed (e.g. the rays it contains were placed in the scheduler
+   * queues) otherwise the node may report itself idle while work is pending.
+   *
+   * @param n Number of messages
+   */
+  void received(const unsigned long n = 1) { _received += n; }
+
+  /**
+   * @brief Progress the termination detection
+   *
+   * Invoked periodically by the scheduler. If no wave is active and the node is idle it starts a new wave, otherwise
+   * it tests if the active wave completed.
+   *
+   * @param idle True if the node has no more local work
+   * @return true if all nodes are idle and no messages are in flight
+   */
+  bool progress(const bool idle);
+
+  /**
+   * @brief Reset the wave state for the next frame
+   *
+   * The message counters are never reset, since a node may receive messages of the next frame before it detects the
+   * termination of the current one.
+   */
+  void reset();
+};
+}
+}
+}
+
+#endif /* TERMINATION_H */
@@ -0,0 +1,62 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#include <gvt/core/context/Atom.h>
+
+#include <tbb/concurrent_unordered_map.h>
+#include <tbb/concurrent_vector.h>
+
+using namespace gvt::core;
+
+namespace {
+struct AtomTable {
+  tbb::concurrent_unordered_map<std::string, unsigned> ids;
+  tbb::concurrent_vector<std::string> names;
+
+  AtomTable() {
+    names.push_back(std::string());
+    ids.insert(std::make_pair(std::string(), 0u));
+  }
+
+  unsigned intern(const std::string &name) {
+    auto it = ids.find(name);
+    if (it != ids.end()) return it->second;
+    // if two threads intern the same new name the loser's slot in names is never referenced
+    const unsigned id = names.push_back(name) - names.begin();
+    return ids.insert(std::make_pair(name, id)).first->second;
+  }
+};
+
+// constructed on first use, atoms may be created during static initialization
+AtomTable &table() {
+  static AtomTable t;
+  return t;
+}
+}
+
+Atom::Atom(const std::string &name) : _id(table().intern(name)) {}
+
+Atom::Atom(const char *name) : _id(table().intern(std::string(name))) {}
+
+const std::string &Atom::str() const { return table().names[_id]; }
@@ -0,0 +1,73 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+#ifndef GVT_CORE_ATOM_H
+#define GVT_CORE_ATOM_H
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+namespace gvt {
+namespace core {
+/// interned name used to index the children of context database nodes
+/**
+Each distinct name is stored once in a process wide table and identified by a small integer, so comparing and hashing
+atoms is as cheap as comparing integers. Constructing an atom from a string looks the string up in the table (without
+locks), hot code should construct the atoms it uses once, e.g.
+
+    static const gvt::core::Atom THREADS("threads");
+    int n = root[THREADS].value().toInteger();
+
+\sa Database, DBNodeH
+*/
+class Atom {
+public:
+  /// the empty name
+  Atom() : _id(0) {}
+  /// intern name
+  explicit Atom(const std::string &name);
+  explicit Atom(const char *name);
+
+  /// atom identifier, equal names have the same identifier
+  unsigned id() const { return _id; }
+  /// interned name
+  const std::string &str() const;
+
+  bool operator==(const Atom &a) const { return _id == a._id; }
+  bool operator!=(const Atom &a) const { return _id != a._id; }
+  bool operator<(const Atom &a) const { return _id < a._id; }
+
+private:
+  unsigned _id;
+};
+}
+}
+
+namespace std {
+template <> struct hash<gvt::core::Atom> {
+  std::size_t operator()(const gvt::core::Atom &a) const { return a.id(); }
+};
+}
+
+#endif // GVT_CORE_ATOM_H
@@ -24,6 +24,11 @@
 #include "CoreContext.h"
 #include "gvt/core/Debug.h"
 
+#include <limits>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
 using namespace gvt::core;
 
 CoreContext *CoreContext::__singleton = nullptr;
@@ -48,6 +53,7 @@ CoreContext::CoreContext() {
   }
 
   __database->setRoot(root);
+  root->clean();
   __rootNode = DBNodeH(root->UUID());
 }
 
@@ -56,6 +62,8 @@ CoreContext::~CoreContext() { delete __database; }
 CoreContext *CoreContext::instance() {
   if (__singleton == nullptr) {
     __singleton = new CoreContext();
+    // cache the root node in the handle, copies returned by getRootNode never search the database
+    __singleton->__rootNode.getNode();
   }
   return static_cast<CoreContext *>(__singleton);
 }
@@ -63,16 +71,15 @@ CoreContext *CoreContext::instance() {
 DBNodeH CoreContext::getNode(Uuid node) {
   DatabaseNode *n = __database->getItem(node);
   if (n)
-    return DBNodeH(n->UUID());
+    return DBNodeH(n);
   else
     return DBNodeH();
 }
 
 DBNodeH CoreContext::createNode(String name, Variant val, Uuid parent) {
   DatabaseNode *np = new DatabaseNode(name, val, Uuid(), parent);
-  DBNodeH node = DBNodeH(np->UUID());
   __database->setItem(np);
-  return node;
+  return DBNodeH(np);
 }
 
 DBNodeH CoreContext::createNodeFromType(String type, Uuid parent) { return createNodeFromType(type, type, parent); }
@@ -149,43 +156,95 @@ DatabaseNode *CoreContext::unmarsh(gvt::core::Vector<MarshedDatabaseNode> &messa
   return unmarshedParent;
 }
 
+void CoreContext::pack(gvt::core::Vector<unsigned char> &buffer, DatabaseNode &node, const bool delta) {
+  if (!delta || node.dirty()) packRecord(buffer, node);
+  for (DatabaseNode *leaf : node.getChildren()) pack(buffer, *leaf, delta);
+}
+
+void CoreContext::packRecord(gvt::core::Vector<unsigned char> &buffer, DatabaseNode &node) {
+  const std::size_t offset = buffer.size();
+  buffer.resize(offset + sizeof(unsigned) + sizeof(Uuid) + __database->marshLeafBound(node));
+  unsigned char *record = &buffer[offset];
+
+  Uuid parentUUID = node.parentUUID();
+  memcpy(record + sizeof(unsigned), &parentUUID, sizeof(Uuid));
+  const unsigned size =
+      sizeof(unsigned) + sizeof(Uuid) + __database->marshLeaf(record + sizeof(unsigned) + sizeof(Uuid), node);
+  memcpy(record, &size, sizeof(unsigned));
+  buffer.resize(offset + size);
+  node.clean();
+}
+
+std::size_t CoreContext::unpack(const unsigned char *buffer, std::size_t size) {
+  // record offsets, the record sizes are a chain so this pass is sequential
+  gvt::core::Vector<std::size_t> records;
+  for (std::size_t offset = 0; offset < size;) {
+    records.push_back(offset);
+    unsigned recordSize;
+    memcpy(&recordSize, buffer + offset, sizeof(unsigned));
+    offset += recordSize;
+  }
+
+  // decoding allocates the nodes and their values, it does not touch the database. The shipped uuids are copied
+  // over null ones, the default constructor would allocate a new identifier.
+  gvt::core::Vector<DatabaseNode *> nodes(records.size());
+  tbb::parallel_for(tbb::blocked_range<std::size_t>(0, records.size(), 256),
+                    [&](const tbb::blocked_range<std::size_t> &r) {
+                      for (std::size_t i = r.begin(); i != r.end(); ++i) {
+                        unsigned char *record = const_cast<unsigned char *>(buffer + records[i]) + sizeof(unsigned);
+                        Uuid parentUUID = Uuid::null();
+                        memcpy(&parentUUID, record, sizeof(Uuid));
+                        nodes[i] = __database->unmarshLeaf(record + sizeof(Uuid), parentUUID);
+                      }
+                    });
+
+  // parents precede their children in the buffer
+  for (DatabaseNode *node : nodes) {
+    DatabaseNode *existing = __database->getItem(node->UUID());
+    if (!existing) {
+      __database->setItem(node);
+      node->clean();
+      continue;
+    }
+    if (node->name() != String("ptr")) existing->setValue(node->value());
+    existing->clean();
+    delete node;
+  }
+  return nodes.size();
+}
+
 void CoreContext::syncContext() {
 
   const int rankSize = MPI::COMM_WORLD.Get_size();
   const int myRank = MPI::COMM_WORLD.Get_rank();
-  int nTreeNodeEntries = 0;
 
-  gvt::core::Vector<int> mySyncTable(rankSize, 0); // array with the # tree-nodes to send
-  gvt::core::Vector<int> syncTable(rankSize, 0);   // reduced array with the # tree-nodes to send from all nodes
-  gvt::core::Vector<MarshedDatabaseNode> buf;
+  gvt::core::Vector<unsigned char> mine;
+  for (DBNodeH &node : __nodesToSync) pack(mine, node.getNode());
 
-  mySyncTable[myRank] = __nodesToSync.size();
-  MPI::COMM_WORLD.Allreduce(&mySyncTable[0], &syncTable[0], rankSize, MPI_INT, MPI_MAX);
+  // agree on message length, strings length and # leaf are arbitrary
+  gvt::core::Vector<int> sizes(rankSize, 0);
+  gvt::core::Vector<int> displs(rankSize, 0);
+  int mySize = mine.size();
+  MPI::COMM_WORLD.Allgather(&mySize, 1, MPI::INT, &sizes[0], 1, MPI::INT);
 
+  std::size_t total = 0;
   for (int i = 0; i < rankSize; i++) {
-    if (syncTable[i] == 0) continue;
-    for (int treeNode = 0; treeNode < syncTable[i]; treeNode++) {
-
-      if (i == myRank) {
-        DatabaseNode &node = __nodesToSync[treeNode].getNode();
-        marsh(buf, node);
-        nTreeNodeEntries = buf.size();
-      }
-
-      // agree on message length, strings length and # leaf are arbitrary
-      MPI::COMM_WORLD.Bcast(&nTreeNodeEntries, 1, MPI::INT, i);
-      buf.reserve(nTreeNodeEntries);
-      MPI::COMM_WORLD.Bcast(&buf[0], nTreeNodeEntries * CONTEXT_LEAF_MARSH_SIZE, MPI_UNSIGNED_CHAR, i);
+    displs[i] = total;
+    total += sizes[i];
+  }
 
-      if (i != myRank) {
-        unmarsh(buf, nTreeNodeEntries);
-      }
+  if (total > 0) {
+    GVT_ASSERT(total <= std::numeric_limits<int>::max(), "syncContext: packed context exceeds 2GB");
+    gvt::core::Vector<unsigned char> all(total);
+    MPI::COMM_WORLD.Allgatherv(mine.empty() ? nullptr : &mine[0], mySize, MPI_UNSIGNED_CHAR, &all[0], &sizes[0],
+                               &displs[0], MPI_UNSIGNED_CHAR);
 
-      buf.clear();
+    // apply in rank order, as if every node had broadcast its tree-nodes in turn
+    for (int i = 0; i < rankSize; i++) {
+      if (i == myRank || sizes[i] == 0) continue;
+      unpack(&all[displs[i]], sizes[i]);
     }
   }
 
-  MPI::COMM_WORLD.Barrier();
-
   __nodesToSync.clear();
 }
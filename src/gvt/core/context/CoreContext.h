@@ -111,6 +111,19 @@ public:
   // check marsh for buffer structure
   DatabaseNode *unmarsh(gvt::core::Vector<MarshedDatabaseNode> &messagesBuffer, int nNodes);
 
+  /**
+   * Packs a node and its children at the end of a variable length byte buffer
+   * Byte structure (one record per node, parents before their children):
+   * <uint32 record size><parentUUID><UUID><nodeName><int variant type><value>
+   * If delta is set only the nodes changed since they were last synchronized are packed. Packed nodes are marked
+   * clean.
+   */
+  void pack(gvt::core::Vector<unsigned char> &buffer, DatabaseNode &node, const bool delta = true);
+
+  /// Adds or updates the nodes packed in the buffer, returns the number of nodes unpacked
+  /** The records are decoded concurrently and inserted in the database in buffer order. */
+  std::size_t unpack(const unsigned char *buffer, std::size_t size);
+
   DBNodeH addToSync(DBNodeH node) {
     __nodesToSync.push_back(node);
     return node;
@@ -118,7 +131,9 @@ public:
 
   // send and reveives all the tree-nodes marked for syncronization
   // requires all nodes
-  // one to all communication model
+  // the tree-nodes of every node are packed in one buffer and exchanged in a single allgather
+  // only nodes created or assigned since they were last synchronized are sent, values changed in place through
+  // stored pointers (e.g. matrices) are not detected and require the node to be assigned again
   void syncContext();
 
   inline std::shared_ptr<gvt::core::Scheduler> tracer() { return _tracer; }
@@ -126,6 +141,8 @@ public:
 
 protected:
   CoreContext();
+  /// packs a single node record (see pack)
+  void packRecord(gvt::core::Vector<unsigned char> &buffer, DatabaseNode &node);
   static CoreContext *__singleton;
   Database *__database = nullptr;
   DBNodeH __rootNode;
@@ -23,6 +23,7 @@
    ======================================================================================= */
 #include "gvt/core/context/Database.h"
 #include "gvt/core/Debug.h"
+#include <algorithm>
 #include <iostream>
 #include <mpi.h>
 
@@ -31,16 +32,19 @@ using namespace gvt::core;
 Database::Database() {}
 
 Database::~Database() {
-  for (Map<Uuid, DatabaseNode *>::iterator it = __nodes.begin(); it != __nodes.end(); ++it) {
+  for (HashMap<Uuid, DatabaseNode *>::iterator it = __nodes.begin(); it != __nodes.end(); ++it) {
     delete it->second;
   }
 }
 
-DatabaseNode *Database::getItem(Uuid uuid) { return __nodes[uuid]; }
+DatabaseNode *Database::getItem(Uuid uuid) {
+  HashMap<Uuid, DatabaseNode *>::iterator it = __nodes.find(uuid);
+  return (it != __nodes.end()) ? it->second : NULL;
+}
 
 void Database::setItem(DatabaseNode *node) {
   __nodes[node->UUID()] = node;
-  __tree[node->UUID()] = ChildList();
+  __tree[node->UUID()] = Children();
   addChild(node->parentUUID(), node);
 }
 
@@ -50,43 +54,75 @@ bool Database::hasNode(Uuid uuid) { return (__nodes.find(uuid) != __nodes.end())
 
 bool Database::hasNode(DatabaseNode *node) { return (__nodes.find(node->UUID()) != __nodes.end()); }
 
-ChildList &Database::getChildren(Uuid parent) { return __tree[parent]; }
+ChildList &Database::getChildren(Uuid parent) { return __tree[parent].list; }
 
 // add children and keep track of non-leafs nodes by name
 void Database::addChild(Uuid parent, DatabaseNode *node) {
   if (parent == Uuid::null()) return;
-  __tree[parent].push_back(node);
+  Children &children = __tree[parent];
+  children.list.push_back(node);
+  children.byName.insert(std::make_pair(node->atom(), node));
+  __structure = DatabaseNode::tick();
 }
 
-void Database::removeItem(Uuid uuid) {
-  if (__nodes[uuid] != NULL) {
-    DatabaseNode *cnode = getItem(uuid);
+void Database::unindex(Children &parent, DatabaseNode *child) {
+  HashMap<Atom, DatabaseNode *>::iterator it = parent.byName.find(child->atom());
+  if (it == parent.byName.end() || it->second != child) return;
+  parent.byName.erase(it);
+  for (DatabaseNode *n : parent.list) {
+    if (n != child && n->atom() == child->atom()) {
+      parent.byName.insert(std::make_pair(n->atom(), n));
+      break;
+    }
+  }
+}
 
-    ChildList *children = &__tree[uuid];
-    ChildList::iterator it;
+void Database::removeItem(Uuid uuid) {
+  DatabaseNode *cnode = getItem(uuid);
+  if (cnode == NULL) return;
+
+  // remove the children first, each removal erases the child from this node list
+  while (!__tree[uuid].list.empty()) removeItem(__tree[uuid].list.front()->UUID());
+  __tree.erase(uuid);
+
+  HashMap<Uuid, Children>::iterator pit = __tree.find(cnode->parentUUID());
+  if (pit != __tree.end()) {
+    ChildList &siblings = pit->second.list;
+    ChildList::iterator it = std::find(siblings.begin(), siblings.end(), cnode);
+    if (it != siblings.end()) siblings.erase(it);
+    unindex(pit->second, cnode);
+  }
+  __nodes.erase(uuid);
+  __generation++;
+  __structure = DatabaseNode::tick();
+  delete cnode;
+}
 
-    int numChildren = children->size();
-    for (int i = 0; i < numChildren; i++) {
-      removeItem((children->at(0))->UUID());
-    }
-    children = &__tree[cnode->parentUUID()];
-    for (it = children->begin(); it != children->end(); ++it) {
-      if ((*it)->UUID() == uuid) break;
+void Database::renameItem(Uuid uuid, String name) {
+  DatabaseNode *node = getItem(uuid);
+  if (node == NULL) return;
+  HashMap<Uuid, Children>::iterator pit = __tree.find(node->parentUUID());
+  if (pit != __tree.end()) unindex(pit->second, node);
+  node->setName(name);
+  if (pit != __tree.end()) {
+    // keep the first child with the name, as a linear search would
+    for (DatabaseNode *n : pit->second.list) {
+      if (n->atom() == node->atom()) {
+        pit->second.byName[n->atom()] = n;
+        break;
+      }
     }
-    Uuid puid = cnode->parentUUID();
-    if (it != children->end()) children->erase(it);
-    __nodes.erase(uuid);
-    delete cnode;
-  } else {
   }
+  __structure = DatabaseNode::tick();
 }
 
-DatabaseNode *Database::getChildByName(Uuid parent, String name) {
-  ChildList children = __tree[parent];
-  for (ChildList::iterator it = children.begin(); it != children.end(); ++it) {
-    if ((*it)->name() == name) return (*it);
-  }
-  return NULL;
+DatabaseNode *Database::getChildByName(Uuid parent, String name) { return getChildByName(parent, Atom(name)); }
+
+DatabaseNode *Database::getChildByName(Uuid parent, Atom name) {
+  HashMap<Uuid, Children>::iterator pit = __tree.find(parent);
+  if (pit == __tree.end()) return NULL;
+  HashMap<Atom, DatabaseNode *>::iterator it = pit->second.byName.find(name);
+  return (it != pit->second.byName.end()) ? it->second : NULL;
 }
 
 void Database::print(const Uuid &parent, const int depth, std::ostream &os) {
@@ -99,7 +135,7 @@ void Database::print(const Uuid &parent, const int depth, std::ostream &os) {
   for (int i = 0; i < depth; i++) offset += "-";
   os << offset << pnode->UUID().toString() << " : " << pnode->name() << " : " << pnode->value() << std::endl;
   offset += "-";
-  ChildList children = __tree[parent];
+  ChildList &children = getChildren(parent);
   for (ChildList::iterator it = children.begin(); it != children.end(); ++it) {
     DatabaseNode *node = (*it);
     os << offset << node->UUID().toString() << " : " << node->name() << " : " << node->value() << std::endl;
@@ -126,7 +162,7 @@ void Database::printTree(const Uuid &parent, const int depth, std::ostream &os)
   for (int i = 0; i < depth; i++) offset += "-";
   offset += "|";
   os << offset << pnode->UUID().toString() << " : " << pnode->name() << " : " << pnode->value() << std::endl;
-  ChildList children = __tree[parent];
+  ChildList &children = getChildren(parent);
   for (ChildList::iterator it = children.begin(); it != children.end(); ++it) {
     DatabaseNode *node = (*it);
     printTree(node->UUID(), depth + 1, os);
@@ -157,13 +193,22 @@ void Database::setChildValue(Uuid parent, String child, Variant value) {
   if (node) node->setValue(value);
 }
 
-void Database::marshLeaf(unsigned char *buffer, DatabaseNode &leaf) {
+std::size_t Database::marshLeafBound(DatabaseNode &leaf) {
+  std::size_t bound = sizeof(Uuid) + leaf.name().size() + 1 + sizeof(int) + sizeof(glm::mat4);
+  if (leaf.value().type() == 6) bound += leaf.value().toString().size() + 1;
+  return bound;
+}
+
+std::size_t Database::marshLeaf(unsigned char *buffer, DatabaseNode &leaf) {
+  unsigned char *start = buffer;
 
   Uuid leafUUID = leaf.UUID();
   memcpy(buffer, &leafUUID, sizeof(Uuid));
   buffer += sizeof(Uuid);
 
-  const char *name = leaf.name().c_str();
+  // keep the strings alive while their characters are used, name() and toString() return copies
+  const String leafName = leaf.name();
+  const char *name = leafName.c_str();
   memcpy(buffer, name, strlen(name) + 1);
   buffer += strlen(name) + 1;
 
@@ -176,26 +221,31 @@ void Database::marshLeaf(unsigned char *buffer, DatabaseNode &leaf) {
   case 0: {
     int v = leaf.value().toInteger();
     memcpy(buffer, &(v), sizeof(int));
+    buffer += sizeof(int);
     break;
   }
   case 1: {
     long v = leaf.value().toLong();
     memcpy(buffer, &(v), sizeof(long));
+    buffer += sizeof(long);
     break;
   }
   case 2: {
     float v = leaf.value().toFloat();
     memcpy(buffer, &(v), sizeof(float));
+    buffer += sizeof(float);
     break;
   }
   case 3: {
     double v = leaf.value().toDouble();
     memcpy(buffer, &(v), sizeof(double));
+    buffer += sizeof(double);
     break;
   }
   case 4: {
     bool v = leaf.value().toBoolean();
     memcpy(buffer, &(v), sizeof(bool));
+    buffer += sizeof(bool);
     break;
   }
   case 5: { // if pointer, handle according to what the pointer points
@@ -207,24 +257,29 @@ void Database::marshLeaf(unsigned char *buffer, DatabaseNode &leaf) {
 
       v = glm::value_ptr(bbox->bounds_max);
       memcpy(buffer, v, sizeof(float) * 3);
+      buffer += sizeof(float) * 3;
 
     } else if (strcmp(name, "mat") == 0 || strcmp(name, "matInv") == 0) {
       const float *v = (float *)(leaf.value().toULongLong());
       memcpy(buffer, v, sizeof(glm::mat4));
+      buffer += sizeof(glm::mat4);
       break;
     } else if (strcmp(name, "normi") == 0) {
       const float *v = (float *)(leaf.value().toULongLong());
       memcpy(buffer, v, sizeof(glm::mat3));
+      buffer += sizeof(glm::mat3);
       break;
     } else if (strcmp(name, "ptr") == 0) { // if it is actually a pointer, invalidate - separate memory adresses
       memset(buffer, 0, sizeof(unsigned long long));
+      buffer += sizeof(unsigned long long);
     } else
       GVT_ASSERT(false, "Pointer used in marsh");
     break;
   }
   case 6: {
-    const char *vname = leaf.value().toString().c_str();
-    memcpy(buffer, vname, strlen(vname) + 1);
+    const String value = leaf.value().toString();
+    memcpy(buffer, value.c_str(), value.size() + 1);
+    buffer += value.size() + 1;
     break;
   }
   case 7: {
@@ -234,7 +289,8 @@ void Database::marshLeaf(unsigned char *buffer, DatabaseNode &leaf) {
     break;
   }
   case 8: {
-    const float *v = glm::value_ptr(leaf.value().tovec3());
+    const glm::vec3 vec = leaf.value().tovec3();
+    const float *v = glm::value_ptr(vec);
     memcpy(buffer, v, sizeof(float) * 3);
     buffer += sizeof(float) * 3;
     break;
@@ -243,11 +299,12 @@ void Database::marshLeaf(unsigned char *buffer, DatabaseNode &leaf) {
     GVT_ASSERT(false, "marshLeaf: Unknown variant type");
     break;
   }
+  return buffer - start;
 }
 
 DatabaseNode *Database::unmarshLeaf(unsigned char *buffer, Uuid parent) {
 
-  Uuid shippedUUID;
+  Uuid shippedUUID = Uuid::null();
   memcpy(&shippedUUID, buffer, sizeof(Uuid));
   buffer += sizeof(Uuid);
 
@@ -315,7 +372,7 @@ DatabaseNode *Database::unmarshLeaf(unsigned char *buffer, Uuid parent) {
     break;
   }
   case 7: {
-    Uuid shippedUUID;
+    Uuid shippedUUID = Uuid::null();
     memcpy(&shippedUUID, buffer, sizeof(Uuid));
     v = shippedUUID;
     break;
@@ -38,6 +38,10 @@ typedef Vector<DatabaseNode *> ChildList;
 object store database for GraviT. The stored objects are contained in DatabaseNode objects.
 The database and the objects are typicallly accessed using the CoreContext singleton, which
 returns DBNodeH handles to the database objects.
+
+Nodes are stored in hash tables by unique id and the children of each node are indexed by
+their interned name (Atom), so finding a node or a child by name takes constant time. If
+several children share a name, lookups by name return the first one added.
 */
 class Database {
 public:
@@ -77,6 +81,16 @@ public:
   /// return the child node with the given name
   /// that is a child of the parent with the given uuid
   DatabaseNode *getChildByName(Uuid, String);
+  DatabaseNode *getChildByName(Uuid, Atom);
+  /// rename the node with the given uuid, keeping the children index of its parent up to date
+  void renameItem(Uuid, String);
+
+  /// incremented every time nodes are deleted, node pointers obtained with an
+  /// older generation may be dangling (used by DBNodeH to validate its cached node)
+  std::size_t generation() const { return __generation; }
+  /// stamp of the last structural change (nodes added, removed or renamed), comparable with
+  /// DatabaseNode::version() and DatabaseNode::now()
+  std::size_t structure() const { return __structure; }
 
   /// return the value of the node with the given uuid
   Variant getValue(Uuid);
@@ -91,17 +105,31 @@ public:
   /// synced print, all nodes required
   void printTree(const Uuid &parent, int rank, const int depth = 0, std::ostream &os = std::cout);
 
-  /// Copies the node data to a byte buffer
+  /// Copies the node data to a byte buffer, returns the number of bytes written
   /// Structure: <uuid><nodeName><int variant type><value>
-  void marshLeaf(unsigned char *buffer, DatabaseNode &leaf);
+  std::size_t marshLeaf(unsigned char *buffer, DatabaseNode &leaf);
+
+  /// upper bound of the number of bytes marshLeaf writes for the node
+  std::size_t marshLeafBound(DatabaseNode &leaf);
 
   /// Create a node from byte buffer
   /// check marshLeaf for structure
   DatabaseNode *unmarshLeaf(unsigned char *buffer, Uuid parent);
 
 private:
-  Map<Uuid, DatabaseNode *> __nodes;
-  Map<Uuid, ChildList> __tree;
+  /// children of a node, in insertion order and indexed by name
+  struct Children {
+    ChildList list;
+    HashMap<Atom, DatabaseNode *> byName;
+  };
+
+  /// remove child from the name index of parent, another child with the same name takes its place
+  void unindex(Children &parent, DatabaseNode *child);
+
+  HashMap<Uuid, DatabaseNode *> __nodes;
+  HashMap<Uuid, Children> __tree;
+  std::size_t __generation = 0;
+  std::size_t __structure = 0;
 };
 }
 }
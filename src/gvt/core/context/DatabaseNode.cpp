@@ -25,12 +25,23 @@
 #include "gvt/core/Debug.h"
 #include "gvt/core/context/CoreContext.h"
 
+#include <atomic>
+
 using namespace gvt::core;
 
+namespace {
+// change clock shared by all nodes, value changes and structure changes are stamped with it
+std::atomic<std::size_t> __clock(0);
+}
+
+std::size_t DatabaseNode::tick() { return ++__clock; }
+
+std::size_t DatabaseNode::now() { return __clock.load(); }
+
 DatabaseNode *DatabaseNode::errNode = new DatabaseNode(String("error"), String("error"), Uuid::null(), Uuid::null());
 
 DatabaseNode::DatabaseNode(String name, Variant value, Uuid uuid, Uuid parentUUID)
-    : p_uuid(uuid), p_name(name), p_value(value), p_parent(parentUUID) {}
+    : p_uuid(uuid), p_name(name), p_atom(name), p_value(value), p_parent(parentUUID), p_version(tick()) {}
 
 DatabaseNode::operator bool() const { return (!p_uuid.isNull() && !p_parent.isNull()); }
 
@@ -44,11 +55,17 @@ Variant DatabaseNode::value() { return p_value; }
 
 void DatabaseNode::setUUID(Uuid uuid) { p_uuid = uuid; }
 
-void DatabaseNode::setName(String name) { p_name = name; }
+void DatabaseNode::setName(String name) {
+  p_name = name;
+  p_atom = Atom(name);
+}
 
 void DatabaseNode::setParentUUID(Uuid parentUUID) { p_parent = parentUUID; }
 
-void DatabaseNode::setValue(Variant value) { p_value = value; }
+void DatabaseNode::setValue(Variant value) {
+  p_value = value;
+  p_version = tick();
+}
 
 void DatabaseNode::propagateUpdate() {
   DatabaseNode *pn;
@@ -76,12 +93,18 @@ Vector<DatabaseNode *> DatabaseNode::getChildren() {
 
 DBNodeH::DBNodeH(Uuid uuid) : _uuid(uuid) {}
 
+DBNodeH::DBNodeH(DatabaseNode *node) : _uuid(node->UUID()), _node(node) {
+  _generation = CoreContext::instance()->database()->generation();
+}
+
 DatabaseNode &DBNodeH::getNode() {
   CoreContext *ctx = CoreContext::instance();
   Database &db = *(ctx->database());
-  DatabaseNode *n = db.getItem(_uuid);
-  if (n)
-    return *n;
+  if (_node && _generation == db.generation()) return *_node;
+  _node = db.getItem(_uuid);
+  _generation = db.generation();
+  if (_node)
+    return *_node;
   else
     return *DatabaseNode::errNode;
 }
@@ -92,24 +115,26 @@ DBNodeH DBNodeH::deRef() {
   DatabaseNode &n = getNode();
   DatabaseNode *ref = db.getItem(n.value().toUuid());
   if (ref && !n.value().toUuid().isNull()) {
-    return DBNodeH(ref->UUID());
+    return DBNodeH(ref);
   } else {
     return DBNodeH();
   }
 }
 
-DBNodeH DBNodeH::operator[](const String &key) {
+DBNodeH DBNodeH::operator[](const String &key) { return (*this)[Atom(key)]; }
+
+DBNodeH DBNodeH::operator[](const Atom &key) {
   CoreContext *ctx = CoreContext::instance();
   Database &db = *(ctx->database());
   DatabaseNode *child = db.getChildByName(_uuid, key);
   if (!child) {
     // pnav: this isn't an error, since this is one way we create new nodes.
     //       replacing with debug message, since this is useful for finding context issues
-    //GVT_ERR_MESSAGE("DBNodeH[] failed to find key \"" << key << "\" for uuid " << _uuid.toString());
-    GVT_DEBUG(DBG_LOW,"DBNodeH[] failed to find key \"" << key << "\" for uuid " << _uuid.toString());
-    child = &(ctx->createNode(key).getNode());
+    //GVT_ERR_MESSAGE("DBNodeH[] failed to find key \"" << key.str() << "\" for uuid " << _uuid.toString());
+    GVT_DEBUG(DBG_LOW,"DBNodeH[] failed to find key \"" << key.str() << "\" for uuid " << _uuid.toString());
+    child = &(ctx->createNode(key.str()).getNode());
   }
-  return DBNodeH(child->UUID());
+  return DBNodeH(child);
 }
 void DBNodeH::remove() {
   CoreContext *ctx = CoreContext::instance();
@@ -158,13 +183,15 @@ Variant DBNodeH::value() {
 
 void DBNodeH::setUUID(Uuid uuid) {
   _uuid = uuid;
+  _node = nullptr;
   DatabaseNode &n = getNode();
   n.setUUID(uuid);
 }
 
 void DBNodeH::setName(String name) {
-  DatabaseNode &n = getNode();
-  n.setName(name);
+  CoreContext *ctx = CoreContext::instance();
+  Database &db = *(ctx->database());
+  db.renameItem(_uuid, name);
 }
 
 void DBNodeH::setParentUUID(Uuid parentUUID) {
@@ -187,14 +214,17 @@ Vector<DBNodeH> DBNodeH::getChildren() {
   Database &db = *(ctx->database());
   Vector<DatabaseNode *> children = db.getChildren(UUID());
   Vector<DBNodeH> result;
-  for (int i = 0; i < children.size(); i++) result.push_back(DBNodeH(children[i]->UUID()));
+  result.reserve(children.size());
+  for (int i = 0; i < children.size(); i++) result.push_back(DBNodeH(children[i]));
   return result;
 }
 
-DBNodeH DBNodeH::getChildByName(String name) {
+DBNodeH DBNodeH::getChildByName(String name) { return getChildByName(Atom(name)); }
+
+DBNodeH DBNodeH::getChildByName(Atom name) {
   CoreContext *ctx = CoreContext::instance();
   Database &db = *(ctx->database());
   DatabaseNode* child = db.getChildByName(UUID(),name);
-  if (child != NULL) { return DBNodeH(child->UUID()); }
+  if (child != NULL) { return DBNodeH(child); }
   else { return DBNodeH(); }
 }
@@ -34,16 +34,27 @@ class DatabaseNode {
 
   Uuid p_uuid;
   String p_name;
+  Atom p_atom;
   Uuid p_parent;
   Variant p_value;
+  std::size_t p_version;
+  std::size_t p_synced = 0;
 
 public:
   DatabaseNode(String name, Variant value, Uuid uuid, Uuid parentUUID);
 
   Uuid UUID();
   String name();
+  /// interned name, used to index the node among its siblings
+  Atom atom() const { return p_atom; }
   Uuid parentUUID();
   Variant value();
+  /// stamp of the last value change, comparable with tick() and now()
+  std::size_t version() const { return p_version; }
+  /// has the value changed since the node was last shipped to or received from other ranks
+  bool dirty() const { return p_version > p_synced; }
+  /// mark the current value as known by all ranks
+  void clean() { p_synced = p_version; }
 
   void setUUID(Uuid uuid);
   void setName(String name);
@@ -54,12 +65,25 @@ public:
   void propagateUpdate();
   explicit operator bool() const;
 
+  /// advance the database change clock and return the new stamp
+  static std::size_t tick();
+  /// current stamp of the database change clock
+  static std::size_t now();
+
   static DatabaseNode *errNode;
 };
 
+/// handle to a context database node
+/**
+The handle caches the node it refers to, so repeated accesses through the same handle do not
+search the database. The cache is validated against the database generation and refreshed if
+nodes were deleted since it was filled.
+*/
 class DBNodeH {
 public:
   explicit DBNodeH(Uuid u = Uuid::null());
+  /// handle to node, the node is cached
+  explicit DBNodeH(DatabaseNode *node);
   Uuid UUID();
   String name();
   Uuid parentUUID();
@@ -74,6 +98,7 @@ public:
 
   Vector<DBNodeH> getChildren();
   DBNodeH getChildByName(String name);
+  DBNodeH getChildByName(Atom name);
 
   void propagateUpdate();
   DBNodeH deRef();
@@ -82,6 +107,8 @@ public:
   DatabaseNode &getNode();
 
   DBNodeH operator[](const String &key);
+  /// child named key, created if it does not exist (use with atoms constructed once in hot code)
+  DBNodeH operator[](const Atom &key);
   DBNodeH &operator+=(DBNodeH child);
   DBNodeH &operator=(Variant val);
   bool operator==(const Variant val);
@@ -92,6 +119,8 @@ public:
 
 private:
   Uuid _uuid;
+  DatabaseNode *_node = nullptr; /**< Cached node (nullptr if not cached) */
+  std::size_t _generation = 0;   /**< Database generation the cached node was obtained in */
 };
 }
 }
@@ -24,16 +24,40 @@
 
 #include <gvt/core/context/Uuid.h>
 
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
 using namespace gvt::core;
 
-boost::uuids::random_generator Uuid::gen;
+namespace {
+/// sequential uuid allocator, the prefix makes the identifiers of different processes distinct
+struct UuidAllocator {
+  unsigned char prefix[8];
+  std::atomic<std::uint64_t> next;
+
+  UuidAllocator() : next(1) {
+    boost::uuids::uuid r = boost::uuids::random_generator()();
+    memcpy(prefix, r.data, sizeof(prefix));
+  }
+};
+
+// constructed on first use, uuids may be created during static initialization
+UuidAllocator &allocator() {
+  static UuidAllocator a;
+  return a;
+}
+}
 
-Uuid Uuid::null() {
-  Uuid u;
-  u.nullify();
-  return u;
+Uuid::Uuid() {
+  UuidAllocator &a = allocator();
+  const std::uint64_t seq = a.next++;
+  memcpy(uuid.data, a.prefix, sizeof(a.prefix));
+  memcpy(uuid.data + sizeof(a.prefix), &seq, sizeof(seq));
 }
 
+Uuid Uuid::null() { return Uuid(nil_tag()); }
+
 namespace gvt {
 namespace core {
 std::ostream &operator<<(std::ostream &os, const Uuid &u) { return os << u.uuid; }
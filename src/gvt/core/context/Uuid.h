@@ -34,11 +34,13 @@ namespace gvt {
 namespace core {
 /// unique identifier used to tag nodes in the context database
 /**
+* Identifiers are allocated sequentially: a random prefix drawn once per process followed by a
+* sequence number, so creating nodes does not pay for a random uuid each time.
 * \sa CoreContext, Database, DatabaseNode
 */
 class Uuid {
 public:
-  Uuid() : uuid(gen()) {}
+  Uuid();
 
   void nullify() { uuid = boost::uuids::nil_uuid(); }
 
@@ -53,6 +55,8 @@ public:
 
   bool operator<(const Uuid &u) const { return uuid < u.uuid; }
 
+  std::size_t hash() const { return boost::uuids::hash_value(uuid); }
+
   friend std::ostream &operator<<(std::ostream &, const Uuid &);
   static Uuid null();
 
@@ -60,8 +64,15 @@ protected:
   boost::uuids::uuid uuid;
 
 private:
-  static boost::uuids::random_generator gen;
+  struct nil_tag {};
+  explicit Uuid(nil_tag) : uuid(boost::uuids::nil_uuid()) {}
 };
 }
 }
+
+namespace std {
+template <> struct hash<gvt::core::Uuid> {
+  std::size_t operator()(const gvt::core::Uuid &u) const { return u.hash(); }
+};
+}
 #endif // GVT_CORE_UUID_H
@@ -29,6 +29,8 @@
 #include <string>
 
 #if GVT_USE_COUNTER
+#include <gvt/core/comm/communicator.h>
+
 namespace gvt {
 namespace util {
 struct global_counter {
@@ -45,11 +47,9 @@ struct global_counter {
   void add(std::size_t amount) { local_value += amount; }
 
   void print() {
-    unsigned long global;
-    MPI_Reduce(&local_value, &global, 1, MPI_UNSIGNED_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
-    int rank;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    if (rank == 0) std::cout << text << "" << global << std::endl;
+    gvt::comm::communicator &comm = gvt::comm::communicator::instance();
+    unsigned long global = comm.reduceSum(local_value);
+    if (comm.id() == 0) std::cout << text << "" << global << std::endl;
   }
 };
 }
@@ -43,6 +43,21 @@ RenderContext *RenderContext::instance() { return static_cast<RenderContext *>(C
 
 RenderContext::~RenderContext() {}
 
+DBNodeH RenderContext::createInstanceNode(String name, Uuid parent, int id, Uuid meshRef, glm::mat4 *m,
+                                          glm::mat4 *minv, glm::mat3 *normi,
+                                          gvt::render::data::primitives::Box3D *bbox) {
+  DBNodeH n = gvt::core::CoreContext::createNode("Instance", name, parent);
+  const Uuid u = n.UUID();
+  gvt::core::CoreContext::createNode("id", id, u);
+  gvt::core::CoreContext::createNode("meshRef", meshRef, u);
+  gvt::core::CoreContext::createNode("bbox", (unsigned long long)bbox, u);
+  gvt::core::CoreContext::createNode("centroid", bbox->centroid(), u);
+  gvt::core::CoreContext::createNode("mat", (unsigned long long)m, u);
+  gvt::core::CoreContext::createNode("matInv", (unsigned long long)minv, u);
+  gvt::core::CoreContext::createNode("normi", (unsigned long long)normi, u);
+  return n;
+}
+
 DBNodeH RenderContext::createNodeFromType(String type, String name, Uuid parent) {
 
   DBNodeH n = gvt::core::CoreContext::createNode(type, name, parent);
@@ -110,6 +125,13 @@ DBNodeH RenderContext::createNodeFromType(String type, String name, Uuid parent)
   } else if (type == String("Schedule")) {
     n += gvt::core::CoreContext::createNode("type");
     n += gvt::core::CoreContext::createNode("adapter");
+    n += gvt::core::CoreContext::createNode("minBatch", 1);
+    n += gvt::core::CoreContext::createNode("batchTimeout", 1.f);
+    n += gvt::core::CoreContext::createNode("sendBatch", 4096);
+    n += gvt::core::CoreContext::createNode("sendTimeout", 1.f);
+    n += gvt::core::CoreContext::createNode("sendCredits", 65536);
+    n += gvt::core::CoreContext::createNode("maxQueued", 1 << 20);
+    n += gvt::core::CoreContext::createNode("nodeRouting", false);
   }
 
   return n;
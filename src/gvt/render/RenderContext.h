@@ -37,6 +37,12 @@ public:
   virtual ~RenderContext();
   gvt::core::DBNodeH createNodeFromType(gvt::core::String type, gvt::core::String name,
                                         gvt::core::Uuid parent = gvt::core::Uuid::null());
+  /// create an Instance node with all its values set
+  /** Equivalent to createNodeFromType("Instance", ...) followed by assigning each child, without
+      creating the children with placeholder values first. Used by the bulk instance api. */
+  gvt::core::DBNodeH createInstanceNode(gvt::core::String name, gvt::core::Uuid parent, int id,
+                                        gvt::core::Uuid meshRef, glm::mat4 *m, glm::mat4 *minv, glm::mat3 *normi,
+                                        gvt::render::data::primitives::Box3D *bbox);
   static RenderContext *instance();
 
 protected:
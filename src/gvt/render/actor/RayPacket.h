@@ -77,12 +77,13 @@ template <size_t simd_width> struct RayPacketIntersection {
   /**
    * Creates ray packet of the first simd_width elements from list of rays starting at ray_begin.
    * @method RayPacketIntersection
-   * @param  ray_begin             Ray start iterator
+   * @param  ray_begin             Ray start iterator (RayVector iterator or Ray pointer)
    * @param  ray_end               Ray list end iterator
    */
-  inline RayPacketIntersection(const RayVector::iterator &ray_begin, const RayVector::iterator &ray_end) {
+  template <typename RayIterator>
+  inline RayPacketIntersection(const RayIterator &ray_begin, const RayIterator &ray_end) {
     size_t i;
-    RayVector::iterator rayit = ray_begin;
+    RayIterator rayit = ray_begin;
     for (i = 0; rayit != ray_end && i < simd_width; ++i, ++rayit) {
       Ray &ray = (*rayit);
       ox[i] = ray.origin[0];
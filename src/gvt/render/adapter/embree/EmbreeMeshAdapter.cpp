@@ -37,6 +37,7 @@
 #include <gvt/render/data/scene/Light.h>
 
 #include <atomic>
+#include <cstring>
 #include <future>
 #include <thread>
 
@@ -140,22 +141,28 @@ EmbreeMeshAdapter::EmbreeMeshAdapter(gvt::render::data::primitives::Mesh *mesh)
   scene = rtcDeviceNewScene(device, RTC_SCENE_DYNAMIC, GVT_EMBREE_ALGORITHM);
   geomId = rtcNewTriangleMesh(scene, RTC_GEOMETRY_STATIC, numTris, numVerts);
 
-  embVertex *vertices = (embVertex *)rtcMapBuffer(scene, geomId, RTC_VERTEX_BUFFER);
-  for (int i = 0; i < numVerts; i++) {
-    vertices[i].x = mesh->vertices[i][0];
-    vertices[i].y = mesh->vertices[i][1];
-    vertices[i].z = mesh->vertices[i][2];
-  }
-  rtcUnmapBuffer(scene, geomId, RTC_VERTEX_BUFFER);
-
-  embTriangle *triangles = (embTriangle *)rtcMapBuffer(scene, geomId, RTC_INDEX_BUFFER);
-  for (int i = 0; i < numTris; i++) {
-    gvt::render::data::primitives::Mesh::Face f = mesh->faces[i];
-    triangles[i].v0 = f.get<0>();
-    triangles[i].v1 = f.get<1>();
-    triangles[i].v2 = f.get<2>();
+  // the mesh faces are already a flat array of 32-bit indices
+  static_assert(sizeof(embTriangle) == sizeof(gvt::render::data::primitives::Mesh::Face),
+                "embTriangle is not laid out as Mesh::Face");
+
+  if (mesh->isShared()) {
+    // node-shared arrays are used in place (the shared vertex array is padded for the embree vector loads),
+    // only the BVH is built per rank
+    rtcSetBuffer(scene, geomId, RTC_VERTEX_BUFFER, mesh->vertices.data(), 0, sizeof(glm::vec3));
+    rtcSetBuffer(scene, geomId, RTC_INDEX_BUFFER, mesh->getIndices(), 0, sizeof(embTriangle));
+  } else {
+    embVertex *vertices = (embVertex *)rtcMapBuffer(scene, geomId, RTC_VERTEX_BUFFER);
+    for (int i = 0; i < numVerts; i++) {
+      vertices[i].x = mesh->vertices[i][0];
+      vertices[i].y = mesh->vertices[i][1];
+      vertices[i].z = mesh->vertices[i][2];
+    }
+    rtcUnmapBuffer(scene, geomId, RTC_VERTEX_BUFFER);
+
+    embTriangle *triangles = (embTriangle *)rtcMapBuffer(scene, geomId, RTC_INDEX_BUFFER);
+    if (numTris) memcpy(triangles, mesh->getIndices(), sizeof(embTriangle) * numTris);
+    rtcUnmapBuffer(scene, geomId, RTC_INDEX_BUFFER);
   }
-  rtcUnmapBuffer(scene, geomId, RTC_INDEX_BUFFER);
 
   // mesh->writeobj("mesh.obj");
 
@@ -508,14 +515,10 @@ struct embreeParallelTrace {
 #ifndef FLAT_SHADING
                 const float u = ray4.u[pi];
                 const float v = ray4.v[pi];
-                const Mesh::FaceToNormals &normals = mesh->faces_to_normals[triangle_id]; // FIXME: need to
-                                                                                          // figure out
-                                                                                          // to store
-                                                                                          // `faces_to_normals`
-                                                                                          // list
-                const glm::vec3 &a = mesh->normals[normals.get<1>()];
-                const glm::vec3 &b = mesh->normals[normals.get<2>()];
-                const glm::vec3 &c = mesh->normals[normals.get<0>()];
+                const Mesh::FaceToNormals &normals = mesh->getFaceToNormals(triangle_id);
+                const glm::vec3 &a = mesh->normals[normals[1]];
+                const glm::vec3 &b = mesh->normals[normals[2]];
+                const glm::vec3 &c = mesh->normals[normals[0]];
                 manualNormal = a * u + b * v + c * (1.0f - u - v);
                 manualNormal = glm::normalize((*normi) * manualNormal);
 #else
@@ -532,11 +535,7 @@ struct embreeParallelTrace {
 
               const glm::vec3 &normal = manualNormal;
 
-              Material *mat;
-              if (mesh->faces_to_materials.size() && mesh->faces_to_materials[ray4.primID[pi]])
-                mat = mesh->faces_to_materials[ray4.primID[pi]];
-              else
-                mat = mesh->getMaterial();
+              Material *mat = mesh->getFaceMaterial(ray4.primID[pi]);
 
               // reduce contribution of the color that the shadow rays get
               if (r.type == gvt::render::actor::Ray::SECONDARY) {
@@ -606,7 +605,8 @@ void EmbreeMeshAdapter::trace(gvt::render::actor::RayVector &rayList, gvt::rende
   this->begin = _begin;
   this->end = _end;
 
-  const size_t numThreads = gvt::core::CoreContext::instance()->getRootNode()["threads"].value().toInteger();
+  static const gvt::core::Atom THREADS("threads");
+  const size_t numThreads = gvt::core::CoreContext::instance()->getRootNode()[THREADS].value().toInteger();
   const size_t workSize = std::max((size_t)4096, (size_t)((end - begin) / (numThreads * 2))); // size of 'chunk'
                                                                                               // of rays to work
                                                                                               // on
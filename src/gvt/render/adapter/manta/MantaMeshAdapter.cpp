@@ -97,20 +97,20 @@ MantaMeshAdapter::MantaMeshAdapter(gvt::render::data::primitives::Mesh *mesh)
   }
 
   for (int i = 0; i < mesh->faces.size(); ++i) {
-    // Face being boost::tuple<int, int, int>
-    gvt::render::data::primitives::Mesh::Face f = mesh->faces[i];
+    const gvt::render::data::primitives::Mesh::Face &f = mesh->faces[i];
+    const gvt::render::data::primitives::Mesh::FaceToNormals &fn = mesh->getFaceToNormals(i);
     // texture indices
     mantaMesh->texture_indices.push_back(Manta::Mesh::kNoTextureIndex);
     mantaMesh->texture_indices.push_back(Manta::Mesh::kNoTextureIndex);
     mantaMesh->texture_indices.push_back(Manta::Mesh::kNoTextureIndex);
     // vertex indices
-    mantaMesh->vertex_indices.push_back(boost::get<0>(f));
-    mantaMesh->vertex_indices.push_back(boost::get<1>(f));
-    mantaMesh->vertex_indices.push_back(boost::get<2>(f));
+    mantaMesh->vertex_indices.push_back(f[0]);
+    mantaMesh->vertex_indices.push_back(f[1]);
+    mantaMesh->vertex_indices.push_back(f[2]);
     // normal indices
-    mantaMesh->normal_indices.push_back(boost::get<0>(f));
-    mantaMesh->normal_indices.push_back(boost::get<1>(f));
-    mantaMesh->normal_indices.push_back(boost::get<2>(f));
+    mantaMesh->normal_indices.push_back(fn[0]);
+    mantaMesh->normal_indices.push_back(fn[1]);
+    mantaMesh->normal_indices.push_back(fn[2]);
     mantaMesh->face_material.push_back(0);
     // triangle objects (to be deleted inside Manta)
     mantaMesh->addTriangle(new Manta::KenslerShirleyTriangle());
@@ -66,7 +66,9 @@
 
 #include <gvt/render/data/primitives/Material.h>
 
-int3 *cudaCreateFacesToNormals(std::vector<gvt::render::data::primitives::Mesh::FaceToNormals> &gvt_face_to_normals) {
+typedef gvt::render::data::primitives::Mesh GvtMesh;
+
+int3 *cudaCreateFacesToNormals(GvtMesh::Array<GvtMesh::FaceToNormals> &gvt_face_to_normals) {
 
   int3 *faces_to_normalsBuff;
 
@@ -75,9 +77,9 @@ int3 *cudaCreateFacesToNormals(std::vector<gvt::render::data::primitives::Mesh::
   std::vector<int3> faces_to_normals;
   for (int i = 0; i < gvt_face_to_normals.size(); i++) {
 
-    const boost::tuple<int, int, int> &f = gvt_face_to_normals[i];
+    const gvt::render::data::primitives::Mesh::FaceToNormals &f = gvt_face_to_normals[i];
 
-    int3 v = make_int3(f.get<0>(), f.get<1>(), f.get<2>());
+    int3 v = make_int3(f[0], f[1], f[2]);
 
     faces_to_normals.push_back(v);
   }
@@ -88,7 +90,7 @@ int3 *cudaCreateFacesToNormals(std::vector<gvt::render::data::primitives::Mesh::
   return faces_to_normalsBuff;
 }
 
-cuda_vec *cudaCreateNormals(std::vector<glm::vec3> &gvt_normals) {
+cuda_vec *cudaCreateNormals(GvtMesh::Array<glm::vec3> &gvt_normals) {
 
   cuda_vec *normalsBuff;
 
@@ -106,7 +108,7 @@ cuda_vec *cudaCreateNormals(std::vector<glm::vec3> &gvt_normals) {
   return normalsBuff;
 }
 
-int3 *cudaCreateFaces(std::vector<gvt::render::data::primitives::Mesh::Face> &gvt_faces) {
+int3 *cudaCreateFaces(GvtMesh::Array<GvtMesh::Face> &gvt_faces) {
 
   int3 *facesBuff;
 
@@ -115,9 +117,9 @@ int3 *cudaCreateFaces(std::vector<gvt::render::data::primitives::Mesh::Face> &gv
   std::vector<int3> faces;
   for (int i = 0; i < gvt_faces.size(); i++) {
 
-    const boost::tuple<int, int, int> &f = gvt_faces[i];
+    const gvt::render::data::primitives::Mesh::Face &f = gvt_faces[i];
 
-    int3 v = make_int3(f.get<0>(), f.get<1>(), f.get<2>());
+    int3 v = make_int3(f[0], f[1], f[2]);
     faces.push_back(v);
   }
 
@@ -126,7 +128,7 @@ int3 *cudaCreateFaces(std::vector<gvt::render::data::primitives::Mesh::Face> &gv
   return facesBuff;
 }
 
-cuda_vec *cudaCreateVertices(std::vector<glm::vec3> &gvt_verts) {
+cuda_vec *cudaCreateVertices(GvtMesh::Array<glm::vec3> &gvt_verts) {
 
   cuda_vec *buff;
 
@@ -246,7 +248,9 @@ gvt::render::data::cuda_primitives::Mesh cudaInstanceMesh(gvt::render::data::pri
 
   gvt::render::data::cuda_primitives::Mesh cudaMesh;
 
-  cudaMesh.faces_to_normals = cudaCreateFacesToNormals(mesh->faces_to_normals);
+  // without a faces_to_normals list the normals are indexed by the faces
+  cudaMesh.faces_to_normals =
+      cudaCreateFacesToNormals(mesh->faces_to_normals.empty() ? mesh->faces : mesh->faces_to_normals);
   cudaMesh.normals = cudaCreateNormals(mesh->normals);
   cudaMesh.faces = cudaCreateFaces(mesh->faces);
   cudaMesh.mat = cudaCreateMaterial(mesh->mat);
@@ -440,10 +444,10 @@ OptixMeshAdapter::OptixMeshAdapter(gvt::render::data::primitives::Mesh *m)
   tbb::parallel_for(tbb::blocked_range<int>(0, numTris, 128),
                     [&](tbb::blocked_range<int> chunk) {
                       for (int jj = chunk.begin(); jj < chunk.end(); jj++) {
-                        gvt::render::data::primitives::Mesh::Face f = mesh->faces[jj];
-                        faces[jj * 3 + 0] = f.get<0>();
-                        faces[jj * 3 + 1] = f.get<1>();
-                        faces[jj * 3 + 2] = f.get<2>();
+                        const gvt::render::data::primitives::Mesh::Face &f = mesh->faces[jj];
+                        faces[jj * 3 + 0] = f[0];
+                        faces[jj * 3 + 1] = f[1];
+                        faces[jj * 3 + 2] = f[2];
                       }
                     },
                     ap);
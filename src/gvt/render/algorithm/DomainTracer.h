@@ -94,6 +94,14 @@ public:
   gvt::core::Map<gvt::render::data::primitives::Mesh *, gvt::render::Adapter *> adapterCache;
   gvt::core::Map<int, int> mpiInstanceMap;
 
+  // ray exchange in flight (see SendRays and ProgressRays)
+  gvt::core::Vector<MPI_Request> recv_reqs;
+  gvt::core::Vector<unsigned char *> recv_bufs;
+  gvt::core::Vector<int> recv_sizes;
+  gvt::core::Vector<int> recv_rays;
+  gvt::core::Vector<MPI_Request> send_reqs;
+  gvt::core::Vector<unsigned char *> send_bufs;
+
   Tracer(gvt::render::actor::RayVector &rays, gvt::render::data::scene::Image &image) : AbstractTrace(rays, image) {
 
     Initialize();
@@ -254,6 +262,11 @@ public:
     do {
 
       do {
+        // unpack rays that arrived from other ranks
+        t_send.resume();
+        ProgressRays(false);
+        t_send.stop();
+
         // process domain with most rays queued
         instTarget = -1;
         instTargetCount = 0;
@@ -341,8 +354,13 @@ public:
           shuffleRays(moved_rays, instTarget);
           moved_rays.clear();
           t_shuffle.stop();
+        } else if (ExchangePending()) {
+          // nothing to trace, wait for the rays still in flight
+          t_send.resume();
+          ProgressRays(true);
+          t_send.stop();
         }
-      } while (instTarget != -1);
+      } while (instTarget != -1 || ExchangePending());
 
       {
         t_send.resume();
@@ -350,24 +368,17 @@ public:
         SendRays(gc_sent);
         // are we done?
 
-        // root proc takes empty flag from all procs
-        int not_done = 0;
+        // all procs agree on the total amount of queued rays (tree reduction, no root funnel)
+        long not_done = 0;
 
         for (auto &q : queue) not_done += q.second.size();
+        not_done += PendingRays();
 
-        int *empties = (mpi.rank == 0) ? new int[mpi.world_size] : NULL;
-        MPI_Gather(&not_done, 1, MPI_INT, empties, 1, MPI_INT, 0, MPI_COMM_WORLD);
-        if (mpi.rank == 0) {
-          not_done = 0;
-          for (size_t i = 0; i < mpi.world_size; ++i) not_done += empties[i];
-          for (size_t i = 0; i < mpi.world_size; ++i) empties[i] = not_done;
-        }
-
-        MPI_Scatter(empties, 1, MPI_INT, &not_done, 1, MPI_INT, 0, MPI_COMM_WORLD);
+        long total_not_done = 0;
+        MPI_Allreduce(&not_done, &total_not_done, 1, MPI_LONG, MPI_SUM, MPI_COMM_WORLD);
 
-        all_done = (not_done == 0);
+        all_done = (total_not_done == 0);
         t_send.stop();
-        delete[] empties;
       }
     } while (!all_done);
 
@@ -386,28 +397,113 @@ public:
     gc_sent.print();
   }
 
-  inline bool SendRays(gvt::util::global_counter &counter) {
-    int *outbound = new int[2 * mpi.world_size];
-    int *inbound = new int[2 * mpi.world_size];
-    MPI_Request *reqs = new MPI_Request[2 * mpi.world_size];
-    MPI_Status *stat = new MPI_Status[2 * mpi.world_size];
-    unsigned char **send_buf = new unsigned char *[mpi.world_size];
-    unsigned char **recv_buf = new unsigned char *[mpi.world_size];
-    int *send_buf_ptr = new int[mpi.world_size];
+  /// unpack a buffer of rays received from another rank into the queues
+  inline void UnpackRays(unsigned char *buf, const int size) {
+    int ptr = 0;
+    while (ptr < size) {
+      int q_number = *((int *)(buf + ptr)); // bds get queue number
+      ptr += sizeof(int);
+      int raysinqueue = *((int *)(buf + ptr)); // bds get rays in this queue
+      ptr += sizeof(int);
+      gvt::render::actor::RayVector &q = queue[q_number];
+      q.reserve(q.size() + raysinqueue);
+      for (int c = 0; c < raysinqueue; ++c) {
+        gvt::render::actor::Ray r(buf + ptr);
+        q.push_back(r);
+        ptr += r.packedSize();
+      }
+    }
+  }
+
+  /// true if the last ray exchange still has messages in flight
+  inline bool ExchangePending() { return !recv_reqs.empty() || !send_reqs.empty(); }
+
+  /// number of rays in receives that did not complete yet
+  inline long PendingRays() {
+    long pending = 0;
+    for (size_t i = 0; i < recv_reqs.size(); ++i)
+      if (recv_reqs[i] != MPI_REQUEST_NULL) pending += recv_rays[i];
+    return pending;
+  }
+
+  /// progress the ray exchange started by SendRays
+  /**
+    Unpacks into the queues the receives that completed since the last call (Testsome). If block is true waits for
+    at least one receive to complete (Waitsome). Once all receives completed and all sends are done the exchange
+    buffers are released. Returns true if rays were unpacked.
+    */
+  inline bool ProgressRays(bool block) {
+    bool unpacked = false;
+
+    if (!recv_reqs.empty()) {
+      gvt::core::Vector<int> idx(recv_reqs.size());
+      int outcount = 0;
+      if (block)
+        MPI_Waitsome(recv_reqs.size(), &recv_reqs[0], &outcount, &idx[0], MPI_STATUSES_IGNORE);
+      else
+        MPI_Testsome(recv_reqs.size(), &recv_reqs[0], &outcount, &idx[0], MPI_STATUSES_IGNORE);
+
+      if (outcount != MPI_UNDEFINED) {
+        for (int i = 0; i < outcount; ++i) {
+          const int n = idx[i];
+          UnpackRays(recv_bufs[n], recv_sizes[n]);
+          delete[] recv_bufs[n];
+          recv_bufs[n] = 0;
+          unpacked = true;
+        }
+      }
+
+      bool all_received = true;
+      for (auto &r : recv_reqs) all_received = all_received && (r == MPI_REQUEST_NULL);
+      if (all_received) {
+        recv_reqs.clear();
+        recv_bufs.clear();
+        recv_sizes.clear();
+        recv_rays.clear();
+      }
+      block = block && !unpacked;
+    }
+
+    if (recv_reqs.empty() && !send_reqs.empty()) {
+      int sent = 0;
+      if (block) {
+        MPI_Waitall(send_reqs.size(), &send_reqs[0], MPI_STATUSES_IGNORE);
+        sent = 1;
+      } else {
+        MPI_Testall(send_reqs.size(), &send_reqs[0], &sent, MPI_STATUSES_IGNORE);
+      }
+      if (sent) {
+        for (auto &b : send_bufs) delete[] b;
+        send_reqs.clear();
+        send_bufs.clear();
+      }
+    }
+    return unpacked;
+  }
 
+  /// send the rays queued for remote instances to their ranks
+  /**
+    Exchanges the outgoing buffer sizes with all ranks, posts the receives and then packs and sends the rays for
+    each destination in turn, so the sends of a destination overlap the packing of the next one. The exchange is left
+    in flight when the method returns: the scheduler unpacks each receive as soon as it completes (see ProgressRays)
+    and can trace the new rays while other messages are still arriving.
+    */
+  inline bool SendRays(gvt::util::global_counter &counter) {
     // if there is only one rank we dont need to go through this routine.
     if (mpi.world_size < 2) return false;
-    // init bufs
-    for (size_t i = 0; i < 2 * mpi.world_size; ++i) {
-      inbound[i] = outbound[i] = 0;
-      reqs[i] = MPI_REQUEST_NULL;
-    }
+
+    // the buffers of the previous exchange are reused, finish it first
+    while (ExchangePending()) ProgressRays(true);
+
+    gvt::core::Vector<int> outbound(2 * mpi.world_size, 0);
+    gvt::core::Vector<int> inbound(2 * mpi.world_size, 0);
+    gvt::core::Vector<gvt::core::Vector<int> > outqueues(mpi.world_size);
 
     // count how many rays are to be sent to each neighbor
     for (auto &q : queue) {
       // n is the rank this vector of rays (q.second) belongs on.
       size_t n = mpiInstanceMap[q.first]; // bds
-      if (n != mpi.rank) {                // bds if instance n is not this rank send rays to it.
+      if (n != mpi.rank && !q.second.empty()) { // bds if instance n is not this rank send rays to it.
         int n_ptr = 2 * n;
         int buf_size = 0;
 
@@ -419,98 +515,54 @@ public:
         outbound[n_ptr + 1] += buf_size;    // size of buffer needed to hold rays
         outbound[n_ptr + 1] += sizeof(int); // bds add space for the queue number
         outbound[n_ptr + 1] += sizeof(int); // bds add space for the number of rays in queue
+        outqueues[n].push_back(q.first);
       }
     }
 
     // let the neighbors know what's coming
     // and find out what's coming here
-
-    int tag = 0;
-    for (size_t n = 0; n < mpi.world_size; ++n) // bds sends to self?
-      MPI_Irecv(&inbound[2 * n], 2, MPI_INT, n, tag, MPI_COMM_WORLD, &reqs[2 * n]);
-    for (size_t n = 0; n < mpi.world_size; ++n) // bds send to self
-      MPI_Isend(&outbound[2 * n], 2, MPI_INT, n, tag, MPI_COMM_WORLD, &reqs[2 * n + 1]);
-
-    MPI_Waitall(2 * mpi.world_size, reqs, stat);
-
-    // set up send and recv buffers
-    for (size_t i = 0, j = 0; i < mpi.world_size; ++i, j += 2) {
-      send_buf_ptr[i] = 0;
-      if (outbound[j] > 0)
-        send_buf[i] = new unsigned char[outbound[j + 1]];
-      else
-        send_buf[i] = 0;
-      if (inbound[j] > 0)
-        recv_buf[i] = new unsigned char[inbound[j + 1]];
-      else
-        recv_buf[i] = 0;
-    }
-    for (size_t i = 0; i < 2 * mpi.world_size; ++i) reqs[i] = MPI_REQUEST_NULL;
+    MPI_Alltoall(&outbound[0], 2, MPI_INT, &inbound[0], 2, MPI_INT, MPI_COMM_WORLD);
 
     //  ************************ post non-blocking receive *********************
-    tag = tag + 1;
+    const int tag = 1;
+    recv_reqs.assign(mpi.world_size, MPI_REQUEST_NULL);
+    recv_bufs.assign(mpi.world_size, 0);
+    recv_sizes.assign(mpi.world_size, 0);
+    recv_rays.assign(mpi.world_size, 0);
     for (size_t n = 0; n < mpi.world_size; ++n) { // bds loop through all ranks
       if (inbound[2 * n] > 0) {
-        MPI_Irecv(recv_buf[n], inbound[2 * n + 1], MPI_UNSIGNED_CHAR, n, tag, MPI_COMM_WORLD, &reqs[2 * n]);
+        recv_bufs[n] = new unsigned char[inbound[2 * n + 1]];
+        recv_sizes[n] = inbound[2 * n + 1];
+        recv_rays[n] = inbound[2 * n];
+        MPI_Irecv(recv_bufs[n], inbound[2 * n + 1], MPI_UNSIGNED_CHAR, n, tag, MPI_COMM_WORLD, &recv_reqs[n]);
       }
     }
-    // ******************** pack the send buffers *********************************
-    // gvt::core::Vector<int> to_del;
-    // for (gvt::core::Map<int, gvt::render::actor::RayVector>::iterator q = queue.begin(); q != queue.end(); ++q) {
-    for (auto &q : queue) {
-      int n = mpiInstanceMap[q.first]; // bds use instance map
-      if (outbound[2 * n] > 0) {
-        *((int *)(send_buf[n] + send_buf_ptr[n])) = q.first;         // bds load queue number into send buffer
-        send_buf_ptr[n] += sizeof(int);                              // bds advance pointer
-        *((int *)(send_buf[n] + send_buf_ptr[n])) = q.second.size(); // bds load number of rays into send buffer
-        send_buf_ptr[n] += sizeof(int);                              // bds advance pointer
-        for (size_t r = 0; r < q.second.size(); ++r) {               // load the rays in this queue
-          gvt::render::actor::Ray ray = (q.second)[r];
-          send_buf_ptr[n] += ray.pack(send_buf[n] + send_buf_ptr[n]);
+
+    // ******************** pack and send one neighbor at a time ********************
+    for (size_t n = 0; n < mpi.world_size; ++n) { // bds loop over all
+      if (outbound[2 * n] == 0) continue;
+      unsigned char *buf = new unsigned char[outbound[2 * n + 1]];
+      int ptr = 0;
+      for (auto &qn : outqueues[n]) {
+        gvt::render::actor::RayVector &q = queue[qn];
+        *((int *)(buf + ptr)) = qn;       // bds load queue number into send buffer
+        ptr += sizeof(int);               // bds advance pointer
+        *((int *)(buf + ptr)) = q.size(); // bds load number of rays into send buffer
+        ptr += sizeof(int);               // bds advance pointer
+        for (size_t r = 0; r < q.size(); ++r) { // load the rays in this queue
+          ptr += q[r].pack(buf + ptr);
         }
-        // to_del.push_back(q->first);
-        q.second.clear();
+        q.clear();
       }
-    }
-    for (size_t n = 0; n < mpi.world_size; ++n) { // bds loop over all
       counter.add(outbound[2 * n + 1]);
-      if (outbound[2 * n] > 0) {
-        MPI_Isend(send_buf[n], outbound[2 * n + 1], MPI_UNSIGNED_CHAR, n, tag, MPI_COMM_WORLD, &reqs[2 * n + 1]);
-      }
-    }
+      send_bufs.push_back(buf);
+      send_reqs.push_back(MPI_REQUEST_NULL);
+      MPI_Isend(buf, outbound[2 * n + 1], MPI_UNSIGNED_CHAR, n, tag, MPI_COMM_WORLD, &send_reqs.back());
 
-    MPI_Waitall(2 * mpi.world_size, reqs, stat); // XXX TODO refactor to use Waitany?
-
-    // ******************* unpack rays into the queues **************************
-    for (int n = 0; n < mpi.world_size; ++n) { // bds loop over all
-      if (inbound[2 * n] > 0) {
-        int ptr = 0;
-        while (ptr < inbound[2 * n + 1]) {
-          int q_number = *((int *)(recv_buf[n] + ptr)); // bds get queue number
-          ptr += sizeof(int);
-          int raysinqueue = *((int *)(recv_buf[n] + ptr)); // bds get rays in this queue
-          ptr += sizeof(int);
-          for (int c = 0; c < raysinqueue; ++c) {
-            gvt::render::actor::Ray r(recv_buf[n] + ptr);
-            queue[q_number].push_back(r);
-            ptr += r.packedSize();
-          }
-        }
-      }
+      // unpack whatever already arrived while we keep packing
+      ProgressRays(false);
     }
 
-    // clean up
-    for (size_t i = 0; i < mpi.world_size; ++i) {
-      delete[] send_buf[i];
-      delete[] recv_buf[i];
-    }
-    delete[] send_buf_ptr;
-    delete[] send_buf;
-    delete[] recv_buf;
-    delete[] inbound;
-    delete[] outbound;
-    delete[] reqs;
-    delete[] stat;
     return false;
   }
 };
@@ -27,8 +27,12 @@ ACI-1339881 and ACI-1339840
 #include <gvt/render/Types.h>
 #include <gvt/render/data/Domains.h>
 
+#include <map>
 #include <string>
+#include <tuple>
 
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
 #include <tbb/task_scheduler_init.h>
 #include <thread>
 
@@ -108,12 +112,22 @@ void createMesh(const std::string name) {
   cntxt->addToSync(ameshnode);
 }
 
+namespace {
+// nodes found by getChildByName, mesh nodes are named by value so finding one scans all the meshes
+gvt::core::Map<std::string, gvt::core::DBNodeH> childByName;
+}
+
 gvt::core::DBNodeH getChildByName(gvt::core::DBNodeH dataNodes, std::string name) {
+  auto it = childByName.find(name);
+  if (it != childByName.end() && it->second.parentUUID() == dataNodes.UUID() && it->second.value() == name)
+    return it->second;
+
   gvt::core::Vector<gvt::core::DBNodeH> kids = dataNodes.getChildren();
   gvt::core::DBNodeH Node;
   for (int k = 0; k < kids.size(); k++) {
     if (kids[k].value() == name) Node = kids[k];
   }
+  if (Node.isValid()) childByName[name] = Node;
   return Node;
 }
 
@@ -139,9 +153,12 @@ void addMeshVertices(const std::string name, const unsigned &n, const float *ver
   gvt::render::data::primitives::Mesh *m =
       reinterpret_cast<gvt::render::data::primitives::Mesh *>(ameshnode["ptr"].value().toULongLong());
 
-  for (int i = 0; i < n * 3; i += 3) {
-    m->addVertex(glm::vec3(vertices[i + 0], vertices[i + 1], vertices[i + 2]));
-    // std::cout << vertices[i + 0] << "," << vertices[i + 1] << "," << vertices[i + 2] << std::endl;
+  // glm::vec3 is three packed floats, append the whole span at once
+  const glm::vec3 *v = reinterpret_cast<const glm::vec3 *>(vertices);
+  m->vertices.insert(m->vertices.end(), v, v + n);
+  for (unsigned i = 0; i < n; i++) {
+    glm::vec3 p = v[i];
+    m->boundingBox.expand(p);
   }
 
   cntxt->addToSync(ameshnode);
@@ -160,6 +177,7 @@ void addMeshTriangles(const std::string name, const unsigned &n, const unsigned
   gvt::render::data::primitives::Mesh *m =
       reinterpret_cast<gvt::render::data::primitives::Mesh *>(ameshnode["ptr"].value().toULongLong());
 
+  m->faces.reserve(m->faces.size() + n);
   for (int i = 0; i < n * 3; i += 3) {
     m->addFace(triangles[i + 0], triangles[i + 1], triangles[i + 2]);
   }
@@ -180,6 +198,8 @@ void finishMesh(const std::string name, const bool compute_normal) {
   gvt::render::data::primitives::Mesh *m =
       reinterpret_cast<gvt::render::data::primitives::Mesh *>(ameshnode["ptr"].value().toULongLong());
   m->computeBoundingBox();
+  // normals given with addMeshVertexNormals are kept
+  if (!m->vertices.empty() && m->normals.size() == m->vertices.size()) m->haveNormals = true;
   if (compute_normal) m->generateNormals();
   ameshnode["bbox"] = reinterpret_cast<unsigned long long>(m->getBoundingBox());
   cntxt->addToSync(ameshnode);
@@ -201,9 +221,8 @@ void addMeshFaceNormals(const std::string name, const unsigned &n, const float *
   gvt::render::data::primitives::Mesh *m =
       reinterpret_cast<gvt::render::data::primitives::Mesh *>(ameshnode["ptr"].value().toULongLong());
 
-  for (int i = 0; i < n * 3; i += 3) {
-    m->face_normals.push_back(glm::vec3(normals[i + 0], normals[i + 1], normals[i + 2]));
-  }
+  const glm::vec3 *fn = reinterpret_cast<const glm::vec3 *>(normals);
+  m->face_normals.insert(m->face_normals.end(), fn, fn + n);
   cntxt->addToSync(ameshnode);
 }
 
@@ -223,9 +242,8 @@ void addMeshVertexNormals(const std::string name, const unsigned &n, const float
   gvt::render::data::primitives::Mesh *m =
       reinterpret_cast<gvt::render::data::primitives::Mesh *>(ameshnode["ptr"].value().toULongLong());
 
-  for (int i = 0; i < n * 3; i += 3) {
-    m->normals.push_back(glm::vec3(normals[i + 0], normals[i + 1], normals[i + 2]));
-  }
+  const glm::vec3 *vn = reinterpret_cast<const glm::vec3 *>(normals);
+  m->normals.insert(m->normals.end(), vn, vn + n);
   cntxt->addToSync(ameshnode);
 }
 
@@ -294,13 +312,23 @@ void addMeshMaterials(const std::string name, const unsigned n, const unsigned *
   gvt::render::data::primitives::Mesh *m =
       reinterpret_cast<gvt::render::data::primitives::Mesh *>(ameshnode["ptr"].value().toULongLong());
 
+  // faces with the same material share one entry of the mesh materials table
+  typedef std::tuple<unsigned, float, float, float, float, float, float, float> MaterialKey;
+  std::map<MaterialKey, uint16_t> table;
+  m->faces_to_materials.reserve(m->faces_to_materials.size() + n);
   for (int i = 0; i < n; i++) {
-    gvt::render::data::primitives::Material *mat = new gvt::render::data::primitives::Material();
-    mat->type = mattype[i];
-    mat->kd = glm::vec3(kd[(i * 3) + 0], kd[(i * 3) + 1], kd[(i * 3) + 2]);
-    mat->ks = glm::vec3(ks[(i * 3) + 0], ks[(i * 3) + 1], ks[(i * 3) + 2]);
-    mat->alpha = alpha[i];
-    m->faces_to_materials.push_back(mat);
+    const MaterialKey key(mattype[i], kd[(i * 3) + 0], kd[(i * 3) + 1], kd[(i * 3) + 2], ks[(i * 3) + 0],
+                          ks[(i * 3) + 1], ks[(i * 3) + 2], alpha[i]);
+    auto it = table.find(key);
+    if (it == table.end()) {
+      gvt::render::data::primitives::Material *mat = new gvt::render::data::primitives::Material();
+      mat->type = mattype[i];
+      mat->kd = glm::vec3(kd[(i * 3) + 0], kd[(i * 3) + 1], kd[(i * 3) + 2]);
+      mat->ks = glm::vec3(ks[(i * 3) + 0], ks[(i * 3) + 1], ks[(i * 3) + 2]);
+      mat->alpha = alpha[i];
+      it = table.insert(std::make_pair(key, m->addMaterial(mat))).first;
+    }
+    m->faces_to_materials.push_back(it->second);
   }
   cntxt->addToSync(ameshnode);
 }
@@ -358,45 +386,67 @@ void addMesh(Box3D *mshbx, Mesh *mesh, string meshname) {
  * \param instId id of this instance
  * \param m transformation matrix that moves and scales instance*/
 
-void addInstance(std::string name, const float *am) {
+namespace {
+static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "glm::vec3 is not three packed floats");
 
+/// create n instances, the mesh of instance i is names[i * nameStride]
+void addInstances(const unsigned n, const std::string *names, const size_t nameStride, const float *am) {
+  if (n == 0) return;
   gvt::render::RenderContext *ctx = gvt::render::RenderContext::instance();
   gvt::core::DBNodeH root = ctx->getRootNode();
   gvt::core::DBNodeH instNodes = root["Instances"];
   gvt::core::DBNodeH dataNodes = root["Data"];
-  gvt::core::DBNodeH ameshnode = getChildByName(dataNodes, name);
-  GVT_ASSERT(ameshnode.isValid(), "Mesh name does not exist : " << name);
-
-  int instID = instNodes.getChildren().size();
-  std::string instname = name + std::to_string(instNodes.getChildren().size());
-
-  gvt::core::DBNodeH instNode = ctx->createNodeFromType("Instance", instname.c_str(), instNodes.UUID());
-
-  std::cout << "Create instance " << instname << std::endl;
-  Box3D *mbox = (Box3D *)ameshnode["bbox"].value().toULongLong();
-  glm::mat4 *m = new glm::mat4(1.f);
-  *m = glm::make_mat4(am);
-
-  // build the instance data
-  auto minv = new glm::mat4(1.f);
-  auto normi = new glm::mat3(1.f);
-  *minv = glm::inverse(*m);
-  *normi = glm::transpose(glm::inverse(glm::mat3(*m)));
-  auto il = glm::vec3((*m) * glm::vec4(mbox->bounds_min, 1.f));
-  auto ih = glm::vec3((*m) * glm::vec4(mbox->bounds_max, 1.f));
-  Box3D *ibox = new gvt::render::data::primitives::Box3D(il, ih);
-  // load the node
-  instNode["id"] = instID;
-  instNode["meshRef"] = ameshnode.UUID();
-  instNode["mat"] = (unsigned long long)m;
-  instNode["matInv"] = (unsigned long long)minv;
-  instNode["normi"] = (unsigned long long)normi;
-  instNode["bbox"] = (unsigned long long)ibox;
-  instNode["centroid"] = ibox->centroid();
-
-  ctx->addToSync(instNode);
+
+  // resolve each mesh once
+  gvt::core::Vector<gvt::core::DBNodeH> meshNodes(n);
+  gvt::core::Vector<Box3D *> meshBoxes(n);
+  for (unsigned i = 0; i < n; i++) {
+    if (i > 0 && names[i * nameStride] == names[(i - 1) * nameStride]) {
+      meshNodes[i] = meshNodes[i - 1];
+      meshBoxes[i] = meshBoxes[i - 1];
+      continue;
+    }
+    meshNodes[i] = getChildByName(dataNodes, names[i * nameStride]);
+    GVT_ASSERT(meshNodes[i].isValid(), "Mesh name does not exist : " << names[i * nameStride]);
+    meshBoxes[i] = (Box3D *)meshNodes[i]["bbox"].value().toULongLong();
+  }
+
+  // build the instance data, allocated in blocks since the nodes only hold pointers
+  glm::mat4 *m = new glm::mat4[n];
+  glm::mat4 *minv = new glm::mat4[n];
+  glm::mat3 *normi = new glm::mat3[n];
+  Box3D *ibox = new Box3D[n];
+  tbb::parallel_for(tbb::blocked_range<unsigned>(0, n, 1024), [&](const tbb::blocked_range<unsigned> &r) {
+    for (unsigned i = r.begin(); i != r.end(); ++i) {
+      m[i] = glm::make_mat4(am + 16 * i);
+      minv[i] = glm::inverse(m[i]);
+      normi[i] = glm::transpose(glm::inverse(glm::mat3(m[i])));
+      auto il = glm::vec3(m[i] * glm::vec4(meshBoxes[i]->bounds_min, 1.f));
+      auto ih = glm::vec3(m[i] * glm::vec4(meshBoxes[i]->bounds_max, 1.f));
+      ibox[i] = Box3D(il, ih);
+    }
+  });
+
+  // load the nodes
+  const int firstID = instNodes.getChildren().size();
+  for (unsigned i = 0; i < n; i++) {
+    const int instID = firstID + i;
+    std::string instname = names[i * nameStride] + std::to_string(instID);
+    ctx->addToSync(ctx->createInstanceNode(instname, instNodes.UUID(), instID, meshNodes[i].UUID(), &m[i], &minv[i],
+                                           &normi[i], &ibox[i]));
+  }
+}
 }
 
+void addInstance(std::string name, const float *am) {
+  std::cout << "Create instance " << name << std::endl;
+  addInstances(1, &name, 0, am);
+}
+
+void addInstances(const std::string name, const unsigned n, const float *m) { addInstances(n, &name, 0, m); }
+
+void addInstances(const unsigned n, const std::string *names, const float *m) { addInstances(n, names, 1, m); }
+
 /* add a point light to the render context
  * \param name the name of the light
  * \param pos the light location in world coordinates
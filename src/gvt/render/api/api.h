@@ -119,6 +119,19 @@ void addMeshMaterials(const std::string name, const unsigned n, const unsigned *
 
 void addInstance(std::string name, const float *m);
 
+/* Insert n instances of a named mesh at once.
+ * Much cheaper than n calls to addInstance, the instance data is computed in parallel.
+ * \param name the name of the mesh the instances refer to.
+ * \param n number of instances
+ * \param m transformation matrices, 16 consecutive floats per instance (as in addInstance)*/
+void addInstances(const std::string name, const unsigned n, const float *m);
+
+/* Insert n instances of several meshes at once.
+ * \param n number of instances
+ * \param names the name of the mesh each instance refers to (n names)
+ * \param m transformation matrices, 16 consecutive floats per instance (as in addInstance)*/
+void addInstances(const unsigned n, const std::string *names, const float *m);
+
 /* add a point light to the render context
  * \param name the name of the light
  * \param pos the light location in world coordinates
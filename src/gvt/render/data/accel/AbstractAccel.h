@@ -44,6 +44,7 @@ namespace accel {
 /// abstract base class for acceleration structures
 class AbstractAccel {
 public:
+  AbstractAccel() {}
   AbstractAccel(gvt::core::Vector<gvt::core::DBNodeH> &instanceSet) : instanceSet(instanceSet) {}
 
   virtual ~AbstractAccel() {}
@@ -39,21 +39,54 @@ using namespace gvt::render::data::primitives;
 
 // #define DEBUG_ACCEL
 
+namespace {
+const gvt::core::Atom BBOX("bbox");
+const gvt::core::Atom CENTROID("centroid");
+const gvt::core::Atom ID("id");
+}
+
 BVH::BVH(gvt::core::Vector<gvt::core::DBNodeH> &instanceSet) : AbstractAccel(instanceSet), root(NULL) {
-  gvt::core::Vector<gvt::core::DBNodeH> sortedInstanceSet;
-  root = build(sortedInstanceSet, 0, instanceSet.size(), 0);
+  for (auto &node : this->instanceSet) {
+    Box3D *bbox = (Box3D *)node[BBOX].value().toULongLong();
+    instanceSetBB.push_back(bbox ? *bbox : Box3D());
+    instanceSetCentroid.push_back(node[CENTROID].value().tovec3());
+    instanceSetID.push_back(node[ID].value().toInteger());
+  }
+  build();
+}
+
+BVH::BVH(const gvt::render::data::scene::CompiledScene &scene)
+    : instanceSetBB(scene.bounds), instanceSetCentroid(scene.centroid), instanceSetID(scene.id), root(NULL) {
+  build();
+}
+
+void BVH::build() {
+  instanceOrder.resize(instanceSetID.size());
+  for (size_t i = 0; i < instanceOrder.size(); ++i) instanceOrder[i] = i;
+
+  gvt::core::Vector<int> sortedInstanceSet;
+  root = build(sortedInstanceSet, 0, instanceOrder.size(), 0);
 
 #ifdef DEBUG_ACCEL
-  assert(this->instanceSet.size() == sortedInstanceSet.size());
+  assert(instanceOrder.size() == sortedInstanceSet.size());
 #endif
 
-  // this->instanceSet.swap(sortedInstanceSet);
-  std::swap(this->instanceSet, sortedInstanceSet);
-
-  for (auto &node : this->instanceSet) {
-    instanceSetBB.push_back((Box3D *)node["bbox"].value().toULongLong());
-    instanceSetID.push_back(node["id"].value().toInteger());
+  // store the instances in the order the leaves reference them
+  gvt::core::Vector<Box3D> sortedBB;
+  gvt::core::Vector<glm::vec3> sortedCentroid;
+  gvt::core::Vector<int> sortedID;
+  gvt::core::Vector<gvt::core::DBNodeH> sortedNodes;
+  for (int i : sortedInstanceSet) {
+    sortedBB.push_back(instanceSetBB[i]);
+    sortedCentroid.push_back(instanceSetCentroid[i]);
+    sortedID.push_back(instanceSetID[i]);
+    if (!instanceSet.empty()) sortedNodes.push_back(instanceSet[i]);
   }
+  std::swap(instanceSetBB, sortedBB);
+  std::swap(instanceSetCentroid, sortedCentroid);
+  std::swap(instanceSetID, sortedID);
+  std::swap(instanceSet, sortedNodes);
+  std::swap(instanceOrder, sortedInstanceSet);
 }
 
 BVH::~BVH() {
@@ -64,7 +97,7 @@ BVH::~BVH() {
   }
 }
 
-BVH::Node *BVH::build(gvt::core::Vector<gvt::core::DBNodeH> &sortedInstanceSet, int start, int end, int level) {
+BVH::Node *BVH::build(gvt::core::Vector<int> &sortedInstanceSet, int start, int end, int level) {
   Node *node = new Node();
 
   // TODO: better way to manange memory allocation?
@@ -72,10 +105,7 @@ BVH::Node *BVH::build(gvt::core::Vector<gvt::core::DBNodeH> &sortedInstanceSet,
 
   // evaluate bounds
   Box3D bbox;
-  for (int i = start; i < end; ++i) {
-    Box3D *tmpbb = (Box3D *)instanceSet[i]["bbox"].value().toULongLong();
-    bbox.merge(*tmpbb);
-  }
+  for (int i = start; i < end; ++i) bbox.merge(instanceSetBB[instanceOrder[i]]);
 
   int instanceCount = end - start;
 
@@ -91,7 +121,7 @@ BVH::Node *BVH::build(gvt::core::Vector<gvt::core::DBNodeH> &sortedInstanceSet,
     node->instanceSetIdx = sortedInstanceSet.size();
     node->numInstances = instanceCount;
     for (int i = start; i < end; ++i) {
-      sortedInstanceSet.push_back(instanceSet[i]);
+      sortedInstanceSet.push_back(instanceOrder[i]);
     }
     return node;
   }
@@ -105,17 +135,17 @@ BVH::Node *BVH::build(gvt::core::Vector<gvt::core::DBNodeH> &sortedInstanceSet,
 #ifdef DEBUG_ACCEL
 #ifdef DEBUG_ACCEL_DOMAIN_SET
   for (int i = start; i < end; ++i) {
-    glm::vec3 centroid = instanceSet[i]->worldCentroid();
+    glm::vec3 centroid = instanceSetCentroid[instanceOrder[i]];
     bool lessThan = (centroid[splitAxis] < splitPoint);
-    std::cout << "[Lvl" << level << "][SP:" << splitPoint << "][" << i << "][id:" << instanceSet[i]->getDomainID()
+    std::cout << "[Lvl" << level << "][SP:" << splitPoint << "][" << i << "][id:" << instanceSetID[instanceOrder[i]]
               << "][centroid: " << centroid[splitAxis] << "][isLess: " << lessThan << "]\t";
   }
   std::cout << "\n";
 #else
   for (int i = start; i < end; ++i) {
-    glm::vec3 centroid = instanceSet[i]["centroid"].value().tovec3();
+    glm::vec3 centroid = instanceSetCentroid[instanceOrder[i]];
     bool lessThan = (centroid[splitAxis] < splitPoint);
-    int id = instanceSet[i]["id"].value().toInteger();
+    int id = instanceSetID[instanceOrder[i]];
     std::cout << "[Lvl" << level << "][SP:" << splitPoint << "][" << i << "][id:" << id
               << "][centroid: " << centroid[splitAxis] << "][isLess: " << lessThan << "]\t";
   }
@@ -124,9 +154,10 @@ BVH::Node *BVH::build(gvt::core::Vector<gvt::core::DBNodeH> &sortedInstanceSet,
 #endif
 
   // partition domains into two subsets
-  gvt::core::DBNodeH *instanceBound =
-      std::partition(&instanceSet[start], &instanceSet[end - 1] + 1, CentroidLessThan(splitPoint, splitAxis));
-  int splitIdx = instanceBound - &instanceSet[0];
+  gvt::core::Vector<int>::iterator instanceBound =
+      std::partition(instanceOrder.begin() + start, instanceOrder.begin() + end,
+                     CentroidLessThan(instanceSetCentroid, splitPoint, splitAxis));
+  int splitIdx = instanceBound - instanceOrder.begin();
 
   if (splitIdx == start || splitIdx == end) {
 #ifdef DEBUG_ACCEL
@@ -139,7 +170,7 @@ BVH::Node *BVH::build(gvt::core::Vector<gvt::core::DBNodeH> &sortedInstanceSet,
     node->instanceSetIdx = sortedInstanceSet.size();
     node->numInstances = instanceCount;
     for (int i = start; i < end; ++i) {
-      sortedInstanceSet.push_back(instanceSet[i]);
+      sortedInstanceSet.push_back(instanceOrder[i]);
     }
     return node;
   }
@@ -164,9 +195,13 @@ float BVH::findSplitPoint(int splitAxis, int start, int end) {
   float minCost = std::numeric_limits<float>::max();
   float splitPoint;
 
+  // the search is quadratic, gather the boxes of the range once
+  gvt::core::Vector<Box3D> bboxes(end - start);
+  for (int i = start; i < end; ++i) bboxes[i - start] = instanceSetBB[instanceOrder[i]];
+
   for (int i = start; i < end; ++i) {
 
-    Box3D &refBbox = *(Box3D *)instanceSet[i]["bbox"].value().toULongLong();
+    Box3D &refBbox = bboxes[i - start];
 
     for (int e = 0; e < 2; ++e) {
 
@@ -178,7 +213,7 @@ float BVH::findSplitPoint(int splitAxis, int start, int end) {
       int leftCount = 0;
 
       for (int j = start; j < end; ++j) {
-        Box3D &bbox = *(Box3D *)instanceSet[j]["bbox"].value().toULongLong();
+        Box3D &bbox = bboxes[j - start];
         if (bbox.centroid()[splitAxis] < edge) {
           ++leftCount;
           leftBox.merge(bbox);
@@ -35,6 +35,7 @@
 #include <gvt/render/actor/RayPacket.h>
 #include <gvt/render/data/accel/AbstractAccel.h>
 #include <gvt/render/data/primitives/BBox.h>
+#include <gvt/render/data/scene/CompiledScene.h>
 
 namespace gvt {
 namespace render {
@@ -50,6 +51,8 @@ part of its evaluation process.
 class BVH : public AbstractAccel {
 public:
   BVH(gvt::core::Vector<gvt::core::DBNodeH> &instanceSet);
+  /// build the hierarchy over the instances of a compiled scene, without touching the context
+  BVH(const gvt::render::data::scene::CompiledScene &scene);
   ~BVH();
 
   struct hit {
@@ -57,26 +60,25 @@ public:
     float t = FLT_MAX;
   };
 
-  template <size_t simd_width>
-  gvt::core::Vector<hit> intersect(const gvt::render::actor::RayVector::iterator &ray_begin,
-                                   const gvt::render::actor::RayVector::iterator &ray_end, const int from) {
+  template <size_t simd_width, typename RayIterator>
+  gvt::core::Vector<hit> intersect(const RayIterator &ray_begin, const RayIterator &ray_end, const int from) {
 
     gvt::core::Vector<hit> ret((ray_end - ray_begin));
     size_t offset = 0;
 #ifndef GVT_BRUTEFORCE
-    Node *stack[instanceSet.size() * 2];
+    Node *stack[instanceSetID.size() * 2];
     Node **stackptr = stack;
 #endif
 
-    gvt::render::actor::RayVector::iterator chead = ray_begin;
+    RayIterator chead = ray_begin;
     for (; offset < ret.size(); offset += simd_width, chead += simd_width) {
       gvt::render::actor::RayPacketIntersection<simd_width> rp(chead, ray_end);
 
 #ifdef GVT_BRUTEFORCE
-      for (int i = 0; i < instanceSet.size(); i++) {
+      for (int i = 0; i < instanceSetID.size(); i++) {
         if (from == instanceSetID[i]) continue;
         int hit[simd_width];
-        const primitives::Box3D &ibbox = *instanceSetBB[i];
+        const primitives::Box3D &ibbox = instanceSetBB[i];
         rp.intersect(ibbox, hit, true);
         {
           for (int o = 0; o < simd_width; ++o) {
@@ -105,7 +107,7 @@ public:
           int end = start + cur->numInstances;
           for (int i = start; i < end; ++i) {
             if (from == instanceSetID[i]) continue;
-            const primitives::Box3D &ibbox = *instanceSetBB[i];
+            const primitives::Box3D &ibbox = instanceSetBB[i];
             int hit[simd_width];
             if (rp.intersect(ibbox, hit, true)) {
               for (int o = 0; o < simd_width; ++o) {
@@ -140,23 +142,25 @@ private:
   };
 
   struct CentroidLessThan {
-    CentroidLessThan(float splitPoint, int splitAxis) : splitPoint(splitPoint), splitAxis(splitAxis) {}
-    bool operator()(const gvt::core::DBNodeH inst) const {
-      gvt::core::DBNodeH i2 = inst;
-      glm::vec3 centroid = i2["centroid"].value().tovec3();
-      return (centroid[splitAxis] < splitPoint);
-    }
+    CentroidLessThan(const gvt::core::Vector<glm::vec3> &centroids, float splitPoint, int splitAxis)
+        : centroids(centroids), splitPoint(splitPoint), splitAxis(splitAxis) {}
+    bool operator()(const int inst) const { return (centroids[inst][splitAxis] < splitPoint); }
 
+    const gvt::core::Vector<glm::vec3> &centroids;
     float splitPoint;
     int splitAxis;
   };
 
 private:
-  Node *build(gvt::core::Vector<gvt::core::DBNodeH> &sortedDomainSet, int start, int end, int level);
+  /// build the hierarchy over the instance arrays and store them in traversal order
+  void build();
+  Node *build(gvt::core::Vector<int> &sortedInstanceSet, int start, int end, int level);
 
   float findSplitPoint(int splitAxis, int start, int end);
 
-  gvt::core::Vector<gvt::render::data::primitives::Box3D *> instanceSetBB;
+  gvt::core::Vector<int> instanceOrder; /**< Instance indices, partitioned while building */
+  gvt::core::Vector<gvt::render::data::primitives::Box3D> instanceSetBB;
+  gvt::core::Vector<glm::vec3> instanceSetCentroid;
   gvt::core::Vector<int> instanceSetID;
 
 private:
@@ -30,6 +30,15 @@
 #include <gvt/render/data/Primitives.h>
 #include <gvt/render/data/primitives/Mesh.h>
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <utility>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
 using namespace gvt::render::actor;
 using namespace gvt::render::data;
 using namespace gvt::render::data::primitives;
@@ -40,9 +49,15 @@ Mesh::Mesh(Material *mat) : mat(mat), haveNormals(false) {}
 Mesh::Mesh(const Mesh &orig) {
   mat = orig.mat;
   vertices = orig.vertices;
+  mapuv = orig.mapuv;
   normals = orig.normals;
   faces = orig.faces;
+  faces_to_normals = orig.faces_to_normals;
+  face_normals = orig.face_normals;
+  materials = orig.materials;
+  faces_to_materials = orig.faces_to_materials;
   boundingBox = orig.boundingBox;
+  haveNormals = orig.haveNormals;
 }
 
 Mesh::~Mesh() { delete mat; }
@@ -87,56 +102,82 @@ void Mesh::setMaterial(Material *mat_) {
 }
 
 void Mesh::addFace(int v0, int v1, int v2) {
-  GVT_ASSERT((v0 - 1 >= 0) && v0 - 1 < vertices.size(), "Vertex index 0 outside bounds : " << (v0 - 1));
-  GVT_ASSERT((v1 - 1 >= 0) && v1 - 1 < vertices.size(), "Vertex index 1 outside bounds : " << (v1 - 1));
-  GVT_ASSERT((v2 - 1 >= 0) && v2 - 1 < vertices.size(), "Vertex index 2 outside bounds : " << (v2 - 1));
+  GVT_ASSERT(v0 > 0 && v1 > 0 && v2 > 0, "Vertex index outside bounds : " << v0 << " " << v1 << " " << v2);
+  addTriangle(v0 - 1, v1 - 1, v2 - 1);
+}
 
-  if (vertices[v0 - 1] == vertices[v1 - 1] || vertices[v1 - 1] == vertices[v2 - 1] ||
-      vertices[v2 - 1] == vertices[v0 - 1])
-    return;
+void Mesh::addTriangle(uint32_t v0, uint32_t v1, uint32_t v2) {
+  GVT_ASSERT(v0 < vertices.size(), "Vertex index 0 outside bounds : " << v0);
+  GVT_ASSERT(v1 < vertices.size(), "Vertex index 1 outside bounds : " << v1);
+  GVT_ASSERT(v2 < vertices.size(), "Vertex index 2 outside bounds : " << v2);
 
-  faces.push_back(Face(v0 - 1, v1 - 1, v2 - 1));
+  if (vertices[v0] == vertices[v1] || vertices[v1] == vertices[v2] || vertices[v2] == vertices[v0]) return;
+
+  faces.push_back(Face(v0, v1, v2));
 }
 
 void Mesh::addFaceToNormals(Mesh::FaceToNormals face) { faces_to_normals.push_back(face); }
 
+uint16_t Mesh::addMaterial(Material *m) {
+  GVT_ASSERT(materials.size() < 65536, "Too many materials in mesh");
+  materials.push_back(m);
+  return materials.size() - 1;
+}
+
 void Mesh::generateNormals() {
   if (haveNormals) return;
+  // the generated normals are indexed by the face vertices
   normals.clear();
-  face_normals.clear();
   faces_to_normals.clear();
   normals.resize(vertices.size());
-  face_normals.resize(faces.size());
-  faces_to_normals.resize(faces.size());
-  for (int i = 0; i < normals.size(); ++i) normals[i] = glm::vec3(0.0f, 0.0f, 0.0f);
-
-  for (int i = 0; i < faces.size(); ++i) {
-    int I = faces[i].get<0>();
-    int J = faces[i].get<1>();
-    int K = faces[i].get<2>();
-    glm::vec3 const &a = vertices[I];
-    glm::vec3 const &b = vertices[J];
-    glm::vec3 const &c = vertices[K];
-    glm::vec3 u = b - a;
-    glm::vec3 v = c - a;
-    glm::vec3 normal;
-    normal[0] = u[1] * v[2] - u[2] * v[1];
-    normal[1] = u[2] * v[0] - u[0] * v[2];
-    normal[2] = u[0] * v[1] - u[1] * v[0];
-    normal = glm::normalize(normal);
-
-    // glm::vec3 const &a = Triangle.Position[0];
-    // glm::vec3 const &b = Triangle.Position[1];
-    // glm::vec3 const &c = Triangle.Position[2];
-    // Triangle.Normal = glm::normalize(glm::cross(c - a, b - a));
-
-    face_normals[i] = normal;
-    normals[I] += normal;
-    normals[J] += normal;
-    normals[K] += normal;
-    faces_to_normals[i] = FaceToNormals(I, J, K);
+  const size_t nfaces = faces.size();
+  const size_t nverts = vertices.size();
+
+  // face normals
+  gvt::core::Vector<glm::vec3> facen(nfaces);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, nfaces, 4096), [&](const tbb::blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); ++i) {
+      glm::vec3 const &a = vertices[faces[i][0]];
+      glm::vec3 const &b = vertices[faces[i][1]];
+      glm::vec3 const &c = vertices[faces[i][2]];
+      glm::vec3 u = b - a;
+      glm::vec3 v = c - a;
+      glm::vec3 normal;
+      normal[0] = u[1] * v[2] - u[2] * v[1];
+      normal[1] = u[2] * v[0] - u[0] * v[2];
+      normal[2] = u[0] * v[1] - u[1] * v[0];
+      facen[i] = glm::normalize(normal);
+    }
+  });
+
+  // faces around each vertex (CSR), the counts and slots are claimed with atomics
+  gvt::core::Vector<std::atomic<uint32_t> > slot(nverts + 1);
+  for (size_t i = 0; i <= nverts; ++i) slot[i].store(0, std::memory_order_relaxed);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, nfaces, 4096), [&](const tbb::blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); ++i)
+      for (int k = 0; k < 3; ++k) slot[faces[i][k] + 1].fetch_add(1, std::memory_order_relaxed);
+  });
+  gvt::core::Vector<uint32_t> first(nverts + 1, 0);
+  for (size_t i = 0; i < nverts; ++i) {
+    first[i + 1] = first[i] + slot[i + 1].load(std::memory_order_relaxed);
+    slot[i].store(first[i], std::memory_order_relaxed);
   }
-  for (int i = 0; i < normals.size(); ++i) normals[i] = glm::normalize(normals[i]);
+  gvt::core::Vector<uint32_t> around(first[nverts]);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, nfaces, 4096), [&](const tbb::blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); ++i)
+      for (int k = 0; k < 3; ++k) around[slot[faces[i][k]].fetch_add(1, std::memory_order_relaxed)] = i;
+  });
+
+  // each vertex gathers the normals of its faces, no two tasks write the same normal. The faces are
+  // summed in face order so the result does not depend on the scheduling.
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, nverts, 4096), [&](const tbb::blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); ++i) {
+      std::sort(around.begin() + first[i], around.begin() + first[i + 1]);
+      glm::vec3 normal(0.0f, 0.0f, 0.0f);
+      for (uint32_t f = first[i]; f < first[i + 1]; ++f) normal += facen[around[f]];
+      normals[i] = glm::normalize(normal);
+    }
+  });
   haveNormals = true;
 }
 
@@ -171,15 +212,24 @@ void Mesh::generateNormals() {
 //}
 
 Box3D Mesh::computeBoundingBox() {
+  // reduce over min/max corners, copying an empty Box3D does not keep it empty
+  typedef std::pair<glm::vec3, glm::vec3> Bounds;
+  const Bounds empty(glm::vec3(std::numeric_limits<float>::max()), glm::vec3(-std::numeric_limits<float>::max()));
+  const Bounds bounds = tbb::parallel_reduce(
+      tbb::blocked_range<size_t>(0, vertices.size(), 16384), empty,
+      [&](const tbb::blocked_range<size_t> &r, Bounds b) {
+        for (size_t i = r.begin(); i != r.end(); ++i) {
+          b.first = glm::min(b.first, vertices[i]);
+          b.second = glm::max(b.second, vertices[i]);
+        }
+        return b;
+      },
+      [](const Bounds &a, const Bounds &b) {
+        return Bounds(glm::min(a.first, b.first), glm::max(a.second, b.second));
+      });
 
   Box3D box;
-  for (int i = 0; i < vertices.size(); i++) {
-
-    glm::vec3 p = vertices[i];
-
-    box.expand(p);
-  }
-
+  if (!vertices.empty()) box = Box3D(bounds.first, bounds.second);
   this->boundingBox = box;
 
   return box;
@@ -197,7 +247,7 @@ void Mesh::writeobj(std::string filename) {
     for (auto &vn : normals) file << "vn " << vn[0] << " " << vn[1] << " " << vn[2] << std::endl;
 
     file << "#vertices " << faces.size() << std::endl;
-    for (auto &f : faces) file << "f " << f.get<0>() + 1 << " " << f.get<1>() + 1 << " " << f.get<2>() + 1 << std::endl;
+    for (auto &f : faces) file << "f " << f[0] + 1 << " " << f[1] + 1 << " " << f[2] + 1 << std::endl;
     file.close();
   }
 }
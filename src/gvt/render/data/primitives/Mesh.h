@@ -35,11 +35,13 @@
 #include <gvt/render/data/primitives/Material.h>
 #include <gvt/render/data/scene/Light.h>
 
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
-#include <boost/container/vector.hpp>
-#include <boost/tuple/tuple.hpp>
-
 namespace gvt {
 namespace render {
 namespace data {
@@ -59,14 +61,99 @@ public:
   virtual gvt::render::data::primitives::Box3D *getBoundingBox() { return NULL; }
 };
 
+/// allocator of the mesh arrays
+/** Plain heap memory, unless the allocator adopts an array that already holds the data (a mesh laid over
+node-shared memory, see SharedMesh). The first allocation of the adopted size returns the adopted array,
+value-initializing its elements leaves them untouched and it is never freed. Copies of the vector
+allocate from the heap, and copy-assigning to an adopting vector moves it to the heap instead of
+overwriting the adopted array.
+*/
+template <class T> struct MeshAllocator {
+  typedef T value_type;
+  typedef std::true_type propagate_on_container_copy_assignment;
+  typedef std::true_type propagate_on_container_move_assignment;
+  typedef std::true_type propagate_on_container_swap;
+  template <class U> struct rebind { typedef MeshAllocator<U> other; };
+
+  T *adopted;
+  std::size_t count;
+  bool taken;
+
+  MeshAllocator() : adopted(NULL), count(0), taken(false) {}
+  MeshAllocator(T *adopted, std::size_t count) : adopted(adopted), count(count), taken(false) {}
+  template <class U> MeshAllocator(const MeshAllocator<U> &) : adopted(NULL), count(0), taken(false) {}
+  MeshAllocator(const MeshAllocator &) = default;
+  MeshAllocator(MeshAllocator &&) = default;
+  MeshAllocator &operator=(MeshAllocator &&) = default;
+  /// copy assignment never adopts an array, copy-assigning a vector with another allocator moves it to the heap
+  MeshAllocator &operator=(const MeshAllocator &other) {
+    if (other.adopted != adopted) {
+      adopted = NULL;
+      count = 0;
+      taken = false;
+    }
+    return *this;
+  }
+
+  T *allocate(std::size_t n) {
+    if (adopted && !taken && n == count) {
+      taken = true;
+      return adopted;
+    }
+    return static_cast<T *>(::operator new(n * sizeof(T)));
+  }
+  void deallocate(T *p, std::size_t) {
+    if (p != adopted) ::operator delete(p);
+  }
+  template <class U> void construct(U *p) {
+    if (!owns(p)) ::new ((void *)p) U();
+  }
+  template <class U, class... Args> void construct(U *p, Args &&... args) {
+    ::new ((void *)p) U(std::forward<Args>(args)...);
+  }
+  MeshAllocator select_on_container_copy_construction() const { return MeshAllocator(); }
+
+  /// true if p is in the adopted array
+  template <class U> bool owns(const U *p) const {
+    const void *q = p;
+    return adopted && q >= (const void *)adopted && q < (const void *)(adopted + count);
+  }
+  bool operator==(const MeshAllocator &other) const { return adopted == other.adopted; }
+  bool operator!=(const MeshAllocator &other) const { return adopted != other.adopted; }
+};
+
 /// geometric mesh
 /** geometric mesh used within geometric domains
+
+Faces are triangles of 0-based 32-bit vertex indices, stored back to back so the face list is also
+the flat index array handed to the adapters (getIndices). Per-vertex normals, texture coordinates,
+face normals and per-face materials are optional and empty unless set. faces_to_normals is only
+needed when the normals are indexed differently from the vertices. Per-face materials are indices
+into the materials table, shared by all faces using the same material.
+
+The arrays of a shared mesh (isShared) lie in memory shared with the other ranks of the compute node and
+must be treated as read-only.
 \sa GeometryDomain
 */
 class Mesh : public AbstractMesh {
 public:
-  typedef boost::tuple<int, int, int> Face;
-  typedef boost::tuple<int, int, int> FaceToNormals;
+  /// triangle, 0-based indices of its three vertices
+  struct Face {
+    uint32_t v[3];
+
+    Face() {}
+    Face(uint32_t v0, uint32_t v1, uint32_t v2) {
+      v[0] = v0;
+      v[1] = v1;
+      v[2] = v2;
+    }
+    uint32_t &operator[](const int i) { return v[i]; }
+    const uint32_t &operator[](const int i) const { return v[i]; }
+    bool operator==(const Face &f) const { return v[0] == f.v[0] && v[1] == f.v[1] && v[2] == f.v[2]; }
+  };
+  typedef Face FaceToNormals;
+  /// mesh array, heap allocated or laid over shared memory
+  template <class T> using Array = std::vector<T, MeshAllocator<T> >;
 
   Mesh(gvt::render::data::primitives::Material *mat = NULL);
   Mesh(const Mesh &orig);
@@ -81,14 +168,37 @@ public:
   virtual void addVertex(glm::vec3 vertex);
   virtual void addNormal(glm::vec3 normal);
   virtual void addTexUV(glm::vec3 texUV);
+  /// add a face from 1-based vertex indices, faces with coincident vertices are dropped
   virtual void addFace(int v0, int v1, int v2);
+  /// add a face from 0-based vertex indices, faces with coincident vertices are dropped
+  virtual void addTriangle(uint32_t v0, uint32_t v1, uint32_t v2);
   virtual void addFaceToNormals(FaceToNormals);
+  /// add a material to the materials table, returns its index for faces_to_materials
+  virtual uint16_t addMaterial(Material *m);
 
   virtual gvt::render::data::primitives::Box3D computeBoundingBox();
   virtual gvt::render::data::primitives::Box3D *getBoundingBox() { return &boundingBox; }
   virtual void generateNormals();
 
   virtual gvt::render::data::primitives::Material *getMaterial() { return mat; }
+
+  /// material of a face, the mesh material unless the face has its own
+  gvt::render::data::primitives::Material *getFaceMaterial(const int face_id) const {
+    if (face_id < 0 || (size_t)face_id >= faces_to_materials.size()) return mat;
+    Material *m = materials[faces_to_materials[face_id]];
+    return m ? m : mat;
+  }
+
+  /// indices into normals of the face vertices
+  const FaceToNormals &getFaceToNormals(const int face_id) const {
+    return faces_to_normals.empty() ? faces[face_id] : faces_to_normals[face_id];
+  }
+
+  /// faces as a flat array of 3 vertex indices per face
+  const uint32_t *getIndices() const { return faces.empty() ? NULL : faces[0].v; }
+
+  /// true if the mesh arrays lie in node-shared memory
+  bool isShared() const { return !vertices.empty() && vertices.get_allocator().owns(vertices.data()); }
   //  virtual gvt::render::data::Color shade(const gvt::render::actor::Ray &r, const glm::vec3 &normal,
   //                                         const gvt::render::data::scene::Light *lsource,
   //                                         const glm::vec3 areaLightPosition);
@@ -106,13 +216,14 @@ public:
 
 public:
   gvt::render::data::primitives::Material *mat;
-  gvt::core::Vector<glm::vec3> vertices;
-  gvt::core::Vector<glm::vec3> mapuv;
-  gvt::core::Vector<glm::vec3> normals;
-  gvt::core::Vector<Face> faces;
-  gvt::core::Vector<FaceToNormals> faces_to_normals;
-  gvt::core::Vector<glm::vec3> face_normals;
-  gvt::core::Vector<Material *> faces_to_materials;
+  Array<glm::vec3> vertices;
+  Array<glm::vec3> mapuv;
+  Array<glm::vec3> normals;
+  Array<Face> faces;
+  Array<FaceToNormals> faces_to_normals;
+  Array<glm::vec3> face_normals;
+  gvt::core::Vector<Material *> materials;
+  Array<uint16_t> faces_to_materials;
   gvt::render::data::primitives::Box3D boundingBox;
   bool haveNormals;
 };
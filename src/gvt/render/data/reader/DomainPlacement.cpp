@@ -0,0 +1,71 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#include <gvt/render/data/reader/DomainPlacement.h>
+
+#include <algorithm>
+#include <mpi.h>
+#include <sys/stat.h>
+
+using namespace gvt::render::data::domain::reader;
+
+const char *DomainPlacement::COST = "cost";
+
+gvt::core::Vector<int> DomainPlacement::assign(const gvt::core::Vector<gvt::core::DBNodeH> &meshNodes) {
+  const int ranks = MPI::COMM_WORLD.Get_size();
+  const size_t n = meshNodes.size();
+
+  gvt::core::Vector<long> cost(n);
+  gvt::core::Vector<std::string> name(n);
+  gvt::core::Vector<gvt::core::Uuid> uuid(n);
+  for (size_t i = 0; i < n; i++) {
+    gvt::core::DBNodeH node = meshNodes[i];
+    cost[i] = node[COST].value().toLong();
+    name[i] = node.value().toString();
+    uuid[i] = node.UUID();
+  }
+
+  // the order only depends on the nodes, not on the order they were added to the context of each rank
+  gvt::core::Vector<size_t> order(n);
+  for (size_t i = 0; i < n; i++) order[i] = i;
+  std::sort(order.begin(), order.end(), [&](const size_t a, const size_t b) {
+    if (cost[a] != cost[b]) return cost[a] > cost[b];
+    if (name[a] != name[b]) return name[a] < name[b];
+    return uuid[a] < uuid[b];
+  });
+
+  gvt::core::Vector<long> load(ranks, 0);
+  gvt::core::Vector<int> rank(n);
+  for (const size_t i : order) {
+    const int r = std::min_element(load.begin(), load.end()) - load.begin();
+    rank[i] = r;
+    load[r] += std::max(cost[i], 1l);
+  }
+  return rank;
+}
+
+long DomainPlacement::fileCost(const std::string &filepath) {
+  struct stat st;
+  return stat(filepath.c_str(), &st) == 0 ? (long)st.st_size : 0;
+}
@@ -0,0 +1,59 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#ifndef GVT_RENDER_DATA_DOMAIN_READER_DOMAIN_PLACEMENT_H
+#define GVT_RENDER_DATA_DOMAIN_READER_DOMAIN_PLACEMENT_H
+
+#include <gvt/core/context/CoreContext.h>
+
+#include <string>
+
+namespace gvt {
+namespace render {
+namespace data {
+namespace domain {
+namespace reader {
+/// decide which rank loads and hosts each domain of a distributed scene
+/** Readers loading a scene across ranks first publish a load cost for every mesh node ("cost", from the file
+header or the file size) and synchronize the context. Every rank then computes the same placement from the
+same costs, without further communication, and loads only the meshes placed on it. Domains are taken
+largest first and given to the least loaded rank.
+*/
+class DomainPlacement {
+public:
+  /// name of the mesh node child holding the load cost
+  static const char *COST;
+
+  /// rank hosting each of the mesh nodes, the nodes may be given in any order
+  static gvt::core::Vector<int> assign(const gvt::core::Vector<gvt::core::DBNodeH> &meshNodes);
+
+  /// load cost of a file without a usable header, its size in bytes
+  static long fileCost(const std::string &filepath);
+};
+}
+}
+}
+}
+}
+#endif /* GVT_RENDER_DATA_DOMAIN_READER_DOMAIN_PLACEMENT_H */
@@ -0,0 +1,219 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#include <gvt/render/data/reader/MeshCache.h>
+
+#include <gvt/core/Debug.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace gvt::render::data::domain::reader;
+using namespace gvt::render::data::primitives;
+
+namespace {
+const char MAGIC[8] = { 'G', 'V', 'T', 'M', 'E', 'S', 'H', '\0' };
+const unsigned VERSION = 3;
+const size_t ALIGN = 64;
+
+/// cache file header, followed by the canonical source path and the mesh arrays (each aligned to ALIGN bytes)
+struct Header {
+  char magic[8];
+  unsigned version;
+  unsigned haveNormals;
+  unsigned long long sourcePath;
+  long long sourceSize;
+  long long sourceMTime;
+  long long sourceMTimeNSec;
+  unsigned long long vertices;
+  unsigned long long mapuv;
+  unsigned long long normals;
+  unsigned long long faces;
+  unsigned long long faces_to_normals;
+  unsigned long long face_normals;
+  float bounds[6];
+};
+
+static_assert(sizeof(Mesh::Face) == 3 * sizeof(int), "Mesh::Face is not three packed ints");
+static_assert(sizeof(Mesh::FaceToNormals) == 3 * sizeof(int), "Mesh::FaceToNormals is not three packed ints");
+
+size_t aligned(size_t offset) { return (offset + ALIGN - 1) & ~(ALIGN - 1); }
+
+/// absolute path of the source without symbolic links, relative and absolute spellings of a file give the same path
+std::string canonical(const std::string &source) {
+  char *real = realpath(source.c_str(), NULL);
+  if (!real) return source;
+  std::string ret(real);
+  free(real);
+  return ret;
+}
+
+bool stamp(const std::string &source, Header &h) {
+  struct stat st;
+  if (stat(source.c_str(), &st) != 0) return false;
+  h.sourceSize = st.st_size;
+  h.sourceMTime = st.st_mtim.tv_sec;
+  h.sourceMTimeNSec = st.st_mtim.tv_nsec;
+  return true;
+}
+
+template <typename T> size_t sizeOf(const Mesh::Array<T> &v) { return v.size() * sizeof(T); }
+
+template <typename T> bool read(Mesh::Array<T> &v, unsigned long long n, const char *base, size_t &offset,
+                                size_t length) {
+  offset = aligned(offset);
+  if (offset + n * sizeof(T) > length) return false;
+  v.resize(n);
+  if (n) memcpy(&v[0], base + offset, n * sizeof(T));
+  offset += n * sizeof(T);
+  return true;
+}
+
+template <typename T> bool write(FILE *f, const Mesh::Array<T> &v, size_t &offset) {
+  static const char zeros[ALIGN] = { 0 };
+  const size_t pad = aligned(offset) - offset;
+  if (pad && fwrite(zeros, 1, pad, f) != pad) return false;
+  offset += pad;
+  if (!v.empty() && fwrite(&v[0], sizeof(T), v.size(), f) != v.size()) return false;
+  offset += sizeOf(v);
+  return true;
+}
+}
+
+std::string MeshCache::path(const std::string &source) {
+  const char *dir = getenv("GVT_MESH_CACHE");
+  struct stat st;
+  const std::string real = canonical(source);
+  if (dir && stat(dir, &st) == 0 && S_ISDIR(st.st_mode)) {
+    // flatten the source path so caches of files with the same name do not collide, '_' is escaped so the
+    // flattened name maps back to a single path
+    std::string name;
+    for (const char c : real) {
+      if (c == '_')
+        name += "__";
+      else if (c == '/')
+        name += "_s";
+      else
+        name += c;
+    }
+    return std::string(dir) + "/" + name + ".gvtcache";
+  }
+  return real + ".gvtcache";
+}
+
+Mesh *MeshCache::load(const std::string &source) {
+  Header expected;
+  if (!stamp(source, expected)) return nullptr;
+
+  const std::string real = canonical(source);
+  const std::string file = path(source);
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) return nullptr;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size < 0 || size_t(st.st_size) < sizeof(Header)) {
+    close(fd);
+    return nullptr;
+  }
+  const size_t length = st.st_size;
+  void *map = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (map == MAP_FAILED) return nullptr;
+  madvise(map, length, MADV_SEQUENTIAL);
+
+  const char *base = (const char *)map;
+  Header h;
+  memcpy(&h, base, sizeof(Header));
+  if (memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION || h.sourceSize != expected.sourceSize ||
+      h.sourceMTime != expected.sourceMTime || h.sourceMTimeNSec != expected.sourceMTimeNSec ||
+      h.sourcePath != real.size() || length < sizeof(Header) + real.size() ||
+      memcmp(base + sizeof(Header), real.data(), real.size()) != 0) {
+    munmap(map, length);
+    return nullptr;
+  }
+
+  Mesh *mesh = new Mesh(new Material());
+  size_t offset = sizeof(Header) + real.size();
+  bool ok = read(mesh->vertices, h.vertices, base, offset, length) &&
+            read(mesh->mapuv, h.mapuv, base, offset, length) && read(mesh->normals, h.normals, base, offset, length) &&
+            read(mesh->faces, h.faces, base, offset, length) &&
+            read(mesh->faces_to_normals, h.faces_to_normals, base, offset, length) &&
+            read(mesh->face_normals, h.face_normals, base, offset, length);
+  munmap(map, length);
+  GVT_WARNING(ok, "Mesh cache " << file << " is truncated, ignoring it");
+  if (!ok) {
+    delete mesh;
+    return nullptr;
+  }
+  mesh->boundingBox = Box3D(glm::vec3(h.bounds[0], h.bounds[1], h.bounds[2]),
+                            glm::vec3(h.bounds[3], h.bounds[4], h.bounds[5]));
+  mesh->haveNormals = h.haveNormals;
+  return mesh;
+}
+
+bool MeshCache::store(const std::string &source, Mesh &mesh) {
+  if (!getenv("GVT_MESH_CACHE")) return false;
+  // per-face materials are pointers into the scene, they can not be restored from the file
+  if (!mesh.materials.empty() || !mesh.faces_to_materials.empty()) return false;
+
+  Header h;
+  memset(&h, 0, sizeof(Header));
+  if (!stamp(source, h)) return false;
+  memcpy(h.magic, MAGIC, sizeof(MAGIC));
+  h.version = VERSION;
+  h.haveNormals = mesh.haveNormals;
+  const std::string real = canonical(source);
+  h.sourcePath = real.size();
+  h.vertices = mesh.vertices.size();
+  h.mapuv = mesh.mapuv.size();
+  h.normals = mesh.normals.size();
+  h.faces = mesh.faces.size();
+  h.faces_to_normals = mesh.faces_to_normals.size();
+  h.face_normals = mesh.face_normals.size();
+  for (int i = 0; i < 3; i++) {
+    h.bounds[i] = mesh.boundingBox.bounds_min[i];
+    h.bounds[3 + i] = mesh.boundingBox.bounds_max[i];
+  }
+
+  // write to a temporary file and rename it, ranks reading the same source may write the cache concurrently
+  const std::string file = path(source);
+  const std::string tmp = file + "." + std::to_string(getpid());
+  FILE *f = fopen(tmp.c_str(), "wb");
+  if (!f) return false;
+  size_t offset = sizeof(Header) + real.size();
+  bool ok = fwrite(&h, sizeof(Header), 1, f) == 1 && fwrite(real.data(), 1, real.size(), f) == real.size() &&
+            write(f, mesh.vertices, offset) && write(f, mesh.mapuv, offset) && write(f, mesh.normals, offset) &&
+            write(f, mesh.faces, offset) && write(f, mesh.faces_to_normals, offset) &&
+            write(f, mesh.face_normals, offset);
+  ok = (fclose(f) == 0) && ok;
+  if (!ok || rename(tmp.c_str(), file.c_str()) != 0) {
+    unlink(tmp.c_str());
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,69 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#ifndef GVT_RENDER_DATA_DOMAIN_READER_MESH_CACHE_H
+#define GVT_RENDER_DATA_DOMAIN_READER_MESH_CACHE_H
+
+#include <gvt/render/data/Primitives.h>
+
+#include <string>
+
+namespace gvt {
+namespace render {
+namespace data {
+namespace domain {
+namespace reader {
+/// binary cache of the meshes built by the readers
+/** Parsing a mesh file, generating its normals and computing its bounds gives the same result every run.
+The cache stores the resulting mesh arrays in a flat binary file that is memory mapped and copied
+into the mesh, skipping all the parsing work. A cache file is only used if it was written for the
+current size and modification time of its source file, and for the same canonical source path
+(recorded in the file). Meshes with per-face materials are not cached.
+
+Caches are placed next to the source file (<source>.gvtcache), sources are named by their canonical
+path so relative and absolute names of a file share the cache. The GVT_MESH_CACHE environment
+variable controls them: unset, existing caches are used but never written; set to a directory,
+caches are read from and written to that directory, named after the flattened canonical path of the
+source ('_' becomes "__" and '/' becomes "_s"); set to any other value, caches are written next to
+the source files.
+*/
+class MeshCache {
+public:
+  /// path of the cache file of the source file
+  static std::string path(const std::string &source);
+
+  /// load the mesh of the source file from its cache, returns nullptr if there is no valid cache
+  static gvt::render::data::primitives::Mesh *load(const std::string &source);
+
+  /// write the cache of the source file if caches are enabled and the mesh has no per-face materials,
+  /// returns true if the cache was written
+  static bool store(const std::string &source, gvt::render::data::primitives::Mesh &mesh);
+};
+}
+}
+}
+}
+}
+
+#endif // GVT_RENDER_DATA_DOMAIN_READER_MESH_CACHE_H
@@ -28,6 +28,7 @@
  * Created on January 22, 2015, 1:36 PM
  */
 
+#include <gvt/render/data/reader/MeshCache.h>
 #include <gvt/render/data/reader/ObjReader.h>
 
 #include <gvt/core/Debug.h>
@@ -69,6 +70,9 @@ ObjReader::ObjReader(const std::string filename) : computeNormals(false) {
   // file.open(filename.c_str());
   // GVT_ASSERT(file.good(), "Error loading obj file " << filename);
 
+  objMesh = MeshCache::load(filename);
+  if (objMesh) return;
+
   Material *m = new Material();
   //  m->type = LAMBERT;
   //  //m->type = EMBREE_MATERIAL_MATTE;
@@ -186,7 +190,9 @@ ObjReader::ObjReader(const std::string filename) : computeNormals(false) {
     vertices_offset += shapes[i].mesh.positions.size() / 3;
   }
 
-  computeNormals = (objMesh->normals.size() == objMesh->vertices.size());
+  // normals given for every vertex are used as they are, otherwise they are generated
+  computeNormals = (objMesh->normals.size() != objMesh->vertices.size());
+  objMesh->haveNormals = !computeNormals;
   std::cout << "Found : " << objMesh->vertices.size() << " vertices" << std::endl;
   std::cout << "Found : " << objMesh->normals.size() << " normals" << std::endl;
   std::cout << "Found : " << objMesh->faces.size() << " normals" << std::endl;
@@ -195,6 +201,7 @@ ObjReader::ObjReader(const std::string filename) : computeNormals(false) {
 
   if (computeNormals) objMesh->generateNormals();
   objMesh->computeBoundingBox();
+  MeshCache::store(filename, *objMesh);
 }
 
 void ObjReader::parseVertex(std::string line) {
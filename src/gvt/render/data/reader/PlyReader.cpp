@@ -22,13 +22,29 @@
    ACI-1339881 and ACI-1339840
    ======================================================================================= */
 
+// tbb is included ahead of ply.h, whose type macros (Int16, ...) clash with its templates
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+
 #include <gvt/render/RenderContext.h>
+#include <gvt/render/data/reader/DomainPlacement.h>
+#include <gvt/render/data/reader/MeshCache.h>
+#include <gvt/render/data/reader/SharedMesh.h>
 #include <gvt/render/data/reader/PlyReader.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fcntl.h>
 #include <fstream>
 #include <iostream>
+#include <limits>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <sys/mman.h>
+#include <unistd.h>
 
 using namespace gvt::render::data::domain::reader;
 using namespace gvt::render::data::primitives;
@@ -51,20 +67,8 @@ PlyProperty face_props[] = {
 };
 
 PlyReader::PlyReader(std::string rootdir, bool dist) {
-  // gvt::comm::communicator &comm = gvt::comm::communicator::instance();
-  // mess I use to open and read the ply file with the c utils I found.
-  PlyFile *in_ply;
-  Vertex *vert;
-  Face *face;
-  int elem_count, nfaces, nverts;
-  int i, j, k;
-  float xmin, ymin, zmin, xmax, ymax, zmax;
-  char *elem_name;
-  ;
-  FILE *myfile;
-  char txt[16];
-  std::string temp;
-  std::string filename, filepath;
+  int k;
+  std::string filepath;
 
   gvt::render::RenderContext *cntxt = gvt::render::RenderContext::instance();
   if (cntxt == NULL) {
@@ -90,105 +94,441 @@ PlyReader::PlyReader(std::string rootdir, bool dist) {
     cout << "Directory \"" << rootdir << "\" contains no .ply files. Exiting." << endl;
     exit(0);
   }
-  // read 'em
-  vector<string>::const_iterator file;
-  // for (k = 0; k < 8; k++) {
-  for (file = files.begin(), k = 0; file != files.end(); file++, k++) {
+
+  const int rank = MPI::COMM_WORLD.Get_rank();
+  gvt::core::Vector<gvt::core::DBNodeH> meshNodes;
+  gvt::core::Vector<int> blocks;
+  if (dist) {
+    // each rank reads a share of the headers and publishes those mesh nodes with their load cost
+    for (k = rank; k < files.size(); k += MPI::COMM_WORLD.Get_size()) {
+      gvt::core::DBNodeH PlyMeshNode = cntxt->createNodeFromType("Mesh", files[k], dataNodes.UUID());
+      PlyMeshNode += cntxt->createNode(DomainPlacement::COST, readCost(files[k]));
+      cntxt->addToSync(PlyMeshNode);
+    }
+    cntxt->syncContext();
+
+    // every rank computes the same placement, and reads only the meshes placed on it
+    gvt::core::Map<std::string, int> index;
+    for (k = 0; k < files.size(); k++) index[files[k]] = k;
+    gvt::core::Vector<gvt::core::DBNodeH> plyNodes;
+    for (gvt::core::DBNodeH node : dataNodes.getChildren())
+      if (index.count(node.value().toString())) plyNodes.push_back(node);
+    const gvt::core::Vector<int> placement = DomainPlacement::assign(plyNodes);
+    for (size_t i = 0; i < plyNodes.size(); i++) {
+      if (placement[i] != rank) continue;
+      meshNodes.push_back(plyNodes[i]);
+      blocks.push_back(index[plyNodes[i].value().toString()]);
+    }
+  } else {
+    // create the mesh nodes first (collective), then read the files concurrently
+    vector<string>::const_iterator file;
+    for (file = files.begin(), k = 0; file != files.end(); file++, k++) {
 // if defined, ply blocks load are divided across available mpi ranks
 // Each block will be loaded by a single mpi rank and a mpi rank can read multiple blocks
 #ifdef DOMAIN_PER_NODE
-    if (!((k >= MPI::COMM_WORLD.Get_rank() * DOMAIN_PER_NODE) &&
-          (k < MPI::COMM_WORLD.Get_rank() * DOMAIN_PER_NODE + DOMAIN_PER_NODE)))
-      continue;
+      if (!((k >= rank * DOMAIN_PER_NODE) && (k < rank * DOMAIN_PER_NODE + DOMAIN_PER_NODE))) continue;
 #endif
 
 // if all ranks read all ply blocks, one has to create the db node which is then broadcasted.
 // if not, since each block will be loaded by only one mpi, this mpi rank will create the db node
 #ifndef DOMAIN_PER_NODE
-    if (MPI::COMM_WORLD.Get_rank() == 0)
+      if (rank == 0)
 #endif
-      gvt::core::DBNodeH PlyMeshNode = cntxt->addToSync(cntxt->createNodeFromType("Mesh", *file, dataNodes.UUID()));
+        gvt::core::DBNodeH PlyMeshNode = cntxt->addToSync(cntxt->createNodeFromType("Mesh", *file, dataNodes.UUID()));
 
 #ifndef DOMAIN_PER_NODE
-    cntxt->syncContext();
-    gvt::core::DBNodeH PlyMeshNode = dataNodes.getChildren()[k];
+      cntxt->syncContext();
+      gvt::core::DBNodeH PlyMeshNode = dataNodes.getChildren()[k];
 #endif
-    filepath = *file;
-    myfile = fopen(filepath.c_str(), "r");
-    in_ply = read_ply(myfile);
-    for (i = 0; i < in_ply->num_elem_types; i++) {
-      elem_name = setup_element_read_ply(in_ply, i, &elem_count);
-      temp = elem_name;
-      if (temp == "vertex") {
-        vlist = (Vertex **)malloc(sizeof(Vertex *) * elem_count);
-        nverts = elem_count;
-        setup_property_ply(in_ply, &vert_props[0]);
-        setup_property_ply(in_ply, &vert_props[1]);
-        setup_property_ply(in_ply, &vert_props[2]);
-        for (j = 0; j < elem_count; j++) {
-          vlist[j] = (Vertex *)malloc(sizeof(Vertex));
-          get_element_ply(in_ply, (void *)vlist[j]);
-        }
-      } else if (temp == "face") {
-        flist = (Face **)malloc(sizeof(Face *) * elem_count);
-        nfaces = elem_count;
-        setup_property_ply(in_ply, &face_props[0]);
-        for (j = 0; j < elem_count; j++) {
-          flist[j] = (Face *)malloc(sizeof(Face));
-          get_element_ply(in_ply, (void *)flist[j]);
-        }
+      meshNodes.push_back(PlyMeshNode);
+      blocks.push_back(k);
+    }
+  }
+
+  // replicated meshes are split between the ranks of the node and shared, distributed ones are read here
+#ifndef DOMAIN_PER_NODE
+  const bool shared = !dist && SharedMesh::enabled();
+#else
+  const bool shared = false;
+#endif
+  gvt::core::Vector<Mesh *> loaded(blocks.size(), NULL);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, blocks.size(), 1), [&](const tbb::blocked_range<size_t> &r) {
+    for (size_t b = r.begin(); b != r.end(); ++b)
+      if (!shared || SharedMesh::loads(b)) loaded[b] = readMesh(files[blocks[b]]);
+  });
+  if (shared) SharedMesh::share(loaded);
+
+  for (size_t b = 0; b < blocks.size(); b++) {
+    filepath = files[blocks[b]];
+    Box3D *meshbbox = new gvt::render::data::primitives::Box3D(loaded[b]->boundingBox);
+    addMesh(meshNodes[b], filepath, loaded[b], meshbbox);
+  }
+
+  cntxt->syncContext();
+}
+
+Mesh *PlyReader::readMesh(const std::string &filepath) {
+  Mesh *mesh = MeshCache::load(filepath);
+  if (mesh) return mesh;
+
+  mesh = new Mesh(new Material());
+  if (!readBinary(filepath, mesh)) {
+    delete mesh;
+    mesh = readAscii(filepath);
+  }
+  mesh->generateNormals(); // keeps the normals read from the file, if any
+  MeshCache::store(filepath, *mesh);
+  return mesh;
+}
+
+Mesh *PlyReader::readAscii(const std::string &filepath) {
+  // the ply library keeps state between calls, files it reads are read one at a time
+  static std::mutex plyLibrary;
+  std::lock_guard<std::mutex> lock(plyLibrary);
+
+  // mess I use to open and read the ply file with the c utils I found.
+  PlyFile *in_ply;
+  Vertex *vert;
+  Face *face;
+  Vertex **vlist = NULL;
+  Face **flist = NULL;
+  int elem_count, nfaces = 0, nverts = 0;
+  int i, j;
+  char *elem_name;
+  FILE *myfile;
+  std::string temp;
+
+  myfile = fopen(filepath.c_str(), "r");
+  in_ply = read_ply(myfile);
+  for (i = 0; i < in_ply->num_elem_types; i++) {
+    elem_name = setup_element_read_ply(in_ply, i, &elem_count);
+    temp = elem_name;
+    if (temp == "vertex") {
+      vlist = (Vertex **)malloc(sizeof(Vertex *) * elem_count);
+      nverts = elem_count;
+      setup_property_ply(in_ply, &vert_props[0]);
+      setup_property_ply(in_ply, &vert_props[1]);
+      setup_property_ply(in_ply, &vert_props[2]);
+      for (j = 0; j < elem_count; j++) {
+        vlist[j] = (Vertex *)malloc(sizeof(Vertex));
+        get_element_ply(in_ply, (void *)vlist[j]);
+      }
+    } else if (temp == "face") {
+      flist = (Face **)malloc(sizeof(Face *) * elem_count);
+      nfaces = elem_count;
+      setup_property_ply(in_ply, &face_props[0]);
+      for (j = 0; j < elem_count; j++) {
+        flist[j] = (Face *)malloc(sizeof(Face));
+        get_element_ply(in_ply, (void *)flist[j]);
+      }
+    }
+  }
+  close_ply(in_ply);
+  // smoosh data into the mesh object
+
+  Material *m = new Material();
+  Mesh *mesh = new Mesh(m);
+  mesh->vertices.reserve(nverts);
+  for (i = 0; i < nverts; i++) {
+    vert = vlist[i];
+    mesh->addVertex(glm::vec3(vert->x, vert->y, vert->z));
+    free(vert);
+  }
+  // add faces to mesh
+  mesh->faces.reserve(nfaces);
+  for (i = 0; i < nfaces; i++) {
+    face = flist[i];
+    mesh->addTriangle(face->verts[0], face->verts[1], face->verts[2]);
+    free(face->verts);
+    free(face);
+  }
+  free(vlist);
+  free(flist);
+  return mesh;
+}
+
+namespace {
+/// scalar property of a binary ply element
+struct BinaryProperty {
+  std::string name;
+  int size = 0;       /**< Bytes of the value (0 for lists) */
+  char kind = 0;      /**< 'i' signed, 'u' unsigned, 'f' floating point */
+  int countSize = 0;  /**< Lists: bytes of the element count */
+  char countKind = 0; /**< Lists: kind of the element count */
+};
+
+struct BinaryElement {
+  std::string name;
+  size_t count = 0;
+  gvt::core::Vector<BinaryProperty> props;
+};
+
+bool plyType(const std::string &t, int &size, char &kind) {
+  if (t == "char" || t == "int8") size = 1, kind = 'i';
+  else if (t == "uchar" || t == "uint8") size = 1, kind = 'u';
+  else if (t == "short" || t == "int16") size = 2, kind = 'i';
+  else if (t == "ushort" || t == "uint16") size = 2, kind = 'u';
+  else if (t == "int" || t == "int32") size = 4, kind = 'i';
+  else if (t == "uint" || t == "uint32") size = 4, kind = 'u';
+  else if (t == "float" || t == "float32") size = 4, kind = 'f';
+  else if (t == "double" || t == "float64") size = 8, kind = 'f';
+  else
+    return false;
+  return true;
+}
+
+/// read a binary value, swapping the bytes if the file endianness differs from the host
+double plyValue(const unsigned char *p, const int size, const char kind, const bool swap) {
+  unsigned char b[8];
+  for (int i = 0; i < size; i++) b[i] = swap ? p[size - 1 - i] : p[i];
+  switch (size) {
+  case 1:
+    return kind == 'i' ? (double)*(signed char *)b : (double)*(unsigned char *)b;
+  case 2:
+    return kind == 'i' ? (double)*(int16_t *)b : (double)*(uint16_t *)b;
+  case 4:
+    return kind == 'f' ? (double)*(float *)b : (kind == 'i' ? (double)*(int32_t *)b : (double)*(uint32_t *)b);
+  default:
+    return *(double *)b;
+  }
+}
+
+/// memory mapped file, unmapped when it goes out of scope
+struct MappedFile {
+  const unsigned char *data = nullptr;
+  size_t size = 0;
+  explicit MappedFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED) {
+        data = (const unsigned char *)map;
+        size = st.st_size;
       }
     }
-    close_ply(in_ply);
-    // smoosh data into the mesh object
-
-    Material *m = new Material();
-    Mesh *mesh = new Mesh(m);
-    vert = vlist[0];
-    xmin = vert->x;
-    ymin = vert->y;
-    zmin = vert->z;
-    xmax = vert->x;
-    ymax = vert->y;
-    zmax = vert->z;
-
-    for (i = 0; i < nverts; i++) {
-      vert = vlist[i];
-      xmin = MIN(vert->x, xmin);
-      ymin = MIN(vert->y, ymin);
-      zmin = MIN(vert->z, zmin);
-      xmax = MAX(vert->x, xmax);
-      ymax = MAX(vert->y, ymax);
-      zmax = MAX(vert->z, zmax);
-      mesh->addVertex(glm::vec3(vert->x, vert->y, vert->z));
+    close(fd);
+  }
+  ~MappedFile() {
+    if (data) munmap((void *)data, size);
+  }
+};
+
+/// parsed ply header
+struct BinaryHeader {
+  std::string format;
+  size_t dataStart = 0; /**< Offset of the element data in the file */
+  gvt::core::Vector<BinaryElement> elements;
+};
+
+/// parse the header of a mapped ply file
+bool readHeader(const MappedFile &file, BinaryHeader &header) {
+  const char *text = (const char *)file.data;
+  if (!text || file.size < 3 || strncmp(text, "ply", 3) != 0) return false;
+  const char *end = (const char *)memmem(text, std::min(file.size, (size_t)65536), "end_header", 10);
+  if (!end) return false;
+  const char *eol = (const char *)memchr(end, '\n', file.size - (end - text));
+  if (!eol) return false;
+  header.dataStart = eol + 1 - text;
+
+  std::istringstream lines(std::string(text, end - text));
+  std::string line;
+  while (std::getline(lines, line)) {
+    std::istringstream words(line);
+    std::string word;
+    words >> word;
+    if (word == "format") {
+      words >> header.format;
+    } else if (word == "element") {
+      header.elements.push_back(BinaryElement());
+      words >> header.elements.back().name >> header.elements.back().count;
+    } else if (word == "property") {
+      if (header.elements.empty()) return false;
+      BinaryProperty prop;
+      words >> word;
+      if (word == "list") {
+        std::string countType, type;
+        words >> countType >> type >> prop.name;
+        if (!plyType(countType, prop.countSize, prop.countKind) || !plyType(type, prop.size, prop.kind)) return false;
+        prop.countSize = -prop.countSize; // marks a list, the value size is the list entry size
+      } else {
+        words >> prop.name;
+        if (!plyType(word, prop.size, prop.kind)) return false;
+      }
+      header.elements.back().props.push_back(prop);
+    }
+  }
+  return header.format == "ascii" || header.format == "binary_little_endian" || header.format == "binary_big_endian";
+}
+}
+
+bool PlyReader::readBinary(const std::string &filepath, Mesh *mesh) {
+  MappedFile file(filepath);
+  if (!file.data) return false;
+
+  BinaryHeader header;
+  if (!readHeader(file, header) || header.format == "ascii") return false; // ascii, read with the ply library
+  const bool hostLittle = (*(const uint16_t *)"\1\0") == 1;
+  const bool swap = (header.format == "binary_big_endian") == hostLittle;
+  const gvt::core::Vector<BinaryElement> &elements = header.elements;
+
+  // locate the vertex and face data, elements before them must have a fixed size to be skipped
+  const unsigned char *data = file.data + header.dataStart;
+  const unsigned char *limit = file.data + file.size;
+  const unsigned char *vertexData = nullptr, *faceData = nullptr;
+  const BinaryElement *vertexElem = nullptr, *faceElem = nullptr;
+  for (const BinaryElement &e : elements) {
+    size_t stride = 0;
+    bool fixed = true;
+    for (const BinaryProperty &p : e.props) {
+      if (p.countSize < 0) fixed = false;
+      stride += p.size;
+    }
+    if (e.name == "vertex") {
+      if (!fixed) return false;
+      vertexData = data;
+      vertexElem = &e;
+    } else if (e.name == "face") {
+      faceData = data;
+      faceElem = &e;
+      break; // face lists have a variable size, nothing after them is needed
+    } else if (!fixed) {
+      return false;
     }
-    glm::vec3 lower(xmin, ymin, zmin);
-    glm::vec3 upper(xmax, ymax, zmax);
-    Box3D *meshbbox = new gvt::render::data::primitives::Box3D(lower, upper);
-    // add faces to mesh
-    for (i = 0; i < nfaces; i++) {
-      face = flist[i];
-      mesh->addFace(face->verts[0] + 1, face->verts[1] + 1, face->verts[2] + 1);
+    data += stride * e.count;
+    if (data > limit) return false;
+  }
+  if (!vertexElem) return false;
+
+  // vertices, fixed size records decoded in parallel
+  size_t vstride = 0;
+  int xyz[3] = { -1, -1, -1 };
+  int nxyz[3] = { -1, -1, -1 };
+  gvt::core::Vector<size_t> offsets;
+  for (const BinaryProperty &p : vertexElem->props) {
+    if (p.name == "x") xyz[0] = offsets.size();
+    if (p.name == "y") xyz[1] = offsets.size();
+    if (p.name == "z") xyz[2] = offsets.size();
+    if (p.name == "nx") nxyz[0] = offsets.size();
+    if (p.name == "ny") nxyz[1] = offsets.size();
+    if (p.name == "nz") nxyz[2] = offsets.size();
+    offsets.push_back(vstride);
+    vstride += p.size;
+  }
+  if (xyz[0] < 0 || xyz[1] < 0 || xyz[2] < 0) return false;
+  const size_t nverts = vertexElem->count;
+  if (vertexData + vstride * nverts > limit) return false;
+
+  // normals stored in the file are used instead of generating them
+  const bool fileNormals = nxyz[0] >= 0 && nxyz[1] >= 0 && nxyz[2] >= 0;
+  mesh->vertices.resize(nverts);
+  if (fileNormals) mesh->normals.resize(nverts);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, nverts, 16384), [&](const tbb::blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); ++i) {
+      const unsigned char *v = vertexData + i * vstride;
+      for (int c = 0; c < 3; c++) {
+        const BinaryProperty &p = vertexElem->props[xyz[c]];
+        mesh->vertices[i][c] = plyValue(v + offsets[xyz[c]], p.size, p.kind, swap);
+      }
+      if (!fileNormals) continue;
+      for (int c = 0; c < 3; c++) {
+        const BinaryProperty &p = vertexElem->props[nxyz[c]];
+        mesh->normals[i][c] = plyValue(v + offsets[nxyz[c]], p.size, p.kind, swap);
+      }
+      mesh->normals[i] = glm::normalize(mesh->normals[i]);
     }
-    mesh->generateNormals();
-
-    PlyMeshNode["file"] = string(filepath);
-    PlyMeshNode["bbox"] = (unsigned long long)meshbbox;
-    PlyMeshNode["ptr"] = (unsigned long long)mesh;
-    gvt::core::DBNodeH loc;
-    if (!dist)
-      loc = cntxt->createNode("rank", MPI::COMM_WORLD.Get_rank());
-    else {
-      loc = cntxt->createNode("rank", (int)(k % MPI::COMM_WORLD.Get_size()));
+  });
+  mesh->haveNormals = fileNormals;
+  mesh->computeBoundingBox();
+
+  if (!faceElem || faceElem->count == 0) return true;
+
+  // faces, only the common layout (a single vertex index list) is read directly
+  if (faceElem->props.size() != 1 || faceElem->props[0].countSize >= 0) return false;
+  const BinaryProperty &list = faceElem->props[0];
+  const int countSize = -list.countSize;
+  const size_t nfaces = faceElem->count;
+
+  // triangle meshes have fixed size records, otherwise the record offsets are found with a sequential scan. Every
+  // count is checked, a single polygon would shift all the following records.
+  const size_t triStride = countSize + 3 * list.size;
+  std::atomic<bool> allTriangles(faceData + triStride * nfaces <= limit);
+  if (allTriangles)
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, nfaces, 65536), [&](const tbb::blocked_range<size_t> &r) {
+      for (size_t i = r.begin(); i != r.end() && allTriangles; ++i)
+        if (plyValue(faceData + i * triStride, countSize, list.countKind, swap) != 3) allTriangles = false;
+    });
+  const bool triangles = allTriangles;
+  gvt::core::Vector<size_t> faceOffset;
+  if (!triangles) {
+    faceOffset.resize(nfaces);
+    const unsigned char *f = faceData;
+    for (size_t i = 0; i < nfaces; i++) {
+      if (f + countSize > limit) return false;
+      faceOffset[i] = f - faceData;
+      f += countSize + (size_t)plyValue(f, countSize, list.countKind, swap) * list.size;
     }
-    PlyMeshNode["Locations"] += loc;
+    if (f > limit) return false;
+  }
+
+  gvt::core::Vector<Mesh::Face> faces(nfaces);
+  gvt::core::Vector<char> keep(nfaces);
+  std::atomic<bool> valid(true);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, nfaces, 16384), [&](const tbb::blocked_range<size_t> &r) {
+    for (size_t i = r.begin(); i != r.end(); ++i) {
+      const unsigned char *f = faceData + (triangles ? i * triStride : faceOffset[i]);
+      const int n = plyValue(f, countSize, list.countKind, swap);
+      keep[i] = false;
+      if (n < 3) continue;
+      int idx[3];
+      bool inside = true;
+      for (int c = 0; c < 3; c++) {
+        idx[c] = plyValue(f + countSize + c * list.size, list.size, list.kind, swap);
+        inside = inside && idx[c] >= 0 && (size_t)idx[c] < nverts;
+      }
+      if (!inside) {
+        valid = false;
+        continue;
+      }
+      faces[i] = Mesh::Face(idx[0], idx[1], idx[2]);
+      // as Mesh::addFace, faces with coincident vertices are dropped
+      const glm::vec3 &a = mesh->vertices[idx[0]], &b = mesh->vertices[idx[1]], &c = mesh->vertices[idx[2]];
+      keep[i] = !(a == b || b == c || c == a);
+    }
+  });
+  if (!valid) return false;
 
-    cntxt->addToSync(PlyMeshNode);
+  mesh->faces.reserve(nfaces);
+  for (size_t i = 0; i < nfaces; i++)
+    if (keep[i]) mesh->faces.push_back(faces[i]);
+  return true;
+}
 
-    meshes.push_back(mesh);
+long PlyReader::readCost(const std::string &filepath) {
+  MappedFile file(filepath);
+  BinaryHeader header;
+  if (!readHeader(file, header)) return DomainPlacement::fileCost(filepath);
+  long cost = 0;
+  for (const BinaryElement &e : header.elements) {
+    // positions and normals per vertex, indices and a normal per face
+    if (e.name == "vertex") cost += e.count * 2 * sizeof(glm::vec3);
+    if (e.name == "face") cost += e.count * (sizeof(Mesh::Face) + sizeof(glm::vec3));
   }
+  return cost;
+}
 
-  cntxt->syncContext();
+void PlyReader::addMesh(gvt::core::DBNodeH PlyMeshNode, const std::string &filepath, Mesh *mesh, Box3D *meshbbox) {
+  gvt::render::RenderContext *cntxt = gvt::render::RenderContext::instance();
+  PlyMeshNode["file"] = string(filepath);
+  PlyMeshNode["bbox"] = (unsigned long long)meshbbox;
+  PlyMeshNode["ptr"] = (unsigned long long)mesh;
+  gvt::core::DBNodeH loc = cntxt->createNode("rank", MPI::COMM_WORLD.Get_rank());
+  PlyMeshNode["Locations"] += loc;
+
+  cntxt->addToSync(PlyMeshNode);
+
+  meshes.push_back(mesh);
 }
 
 PlyReader::~PlyReader() {}
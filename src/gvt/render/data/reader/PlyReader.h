@@ -38,6 +38,10 @@ namespace domain {
 namespace reader {
 /// read ply formatted geometry data
 /** read ply format files and return a Mesh object
+
+With dist set, the files are distributed over the ranks: their headers are read first to place the
+meshes (see DomainPlacement) and each rank only loads the meshes placed on it. Otherwise every rank
+loads every file.
 */
 class PlyReader {
 public:
@@ -79,11 +83,29 @@ public:
     return ret;
   }
 
+  /// meshes loaded by this rank
   gvt::core::Vector<gvt::render::data::primitives::Mesh *> &getMeshes() { return meshes; }
 
+  /// read a ply file from the mesh cache, the binary reader or the ply library, in that order
+  /** does not use the context nor MPI, the mesh has its normals and bounds. Safe to call from several threads.
+  */
+  static gvt::render::data::primitives::Mesh *readMesh(const std::string &filepath);
+
 private:
-  Vertex **vlist;
-  Face **flist;
+  /// store the mesh and its bounds in the mesh node, with this rank as its location, and mark it for synchronization
+  void addMesh(gvt::core::DBNodeH PlyMeshNode, const std::string &filepath,
+               gvt::render::data::primitives::Mesh *mesh, gvt::render::data::primitives::Box3D *meshbbox);
+
+  /// read a binary ply file through a memory map, decoding vertices and faces in parallel
+  /** returns false if the file is not binary or has a layout the reader does not handle
+  */
+  static bool readBinary(const std::string &filepath, gvt::render::data::primitives::Mesh *mesh);
+
+  /// read a ply file with the ply library
+  static gvt::render::data::primitives::Mesh *readAscii(const std::string &filepath);
+
+  /// memory needed by the mesh of a ply file, estimated from its header
+  static long readCost(const std::string &filepath);
 
   gvt::core::Vector<gvt::render::data::primitives::Mesh *> meshes;
 };
@@ -0,0 +1,204 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#include <gvt/render/data/reader/SharedMesh.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace gvt::render::data::domain::reader;
+using namespace gvt::render::data::primitives;
+
+namespace {
+const std::size_t ALIGN = 64;
+// embree loads vertices with 16 byte vector reads, the vertex array is followed by this padding
+const std::size_t VERTEX_PADDING = 16;
+
+enum { VERTICES, MAPUV, NORMALS, FACES, FACES_TO_NORMALS, FACE_NORMALS, FACES_TO_MATERIALS, ARRAYS };
+
+/// mesh header in the window, followed by the materials and the mesh arrays
+struct Record {
+  std::uint64_t count[ARRAYS];
+  std::uint64_t nmaterials;
+  Material mat;
+  glm::vec3 bounds_min;
+  glm::vec3 bounds_max;
+  bool hasMat;
+  bool haveNormals;
+};
+
+/// walks a window segment, or only measures it if base is null
+struct Cursor {
+  char *base;
+  std::size_t offset;
+
+  Cursor(char *base) : base(base), offset(0) {}
+
+  void *take(const std::size_t bytes) {
+    void *p = base ? base + offset : NULL;
+    offset += (bytes + ALIGN - 1) & ~(ALIGN - 1);
+    return p;
+  }
+};
+
+template <typename T> void put(Cursor &c, const Mesh::Array<T> &a, const std::size_t padding = 0) {
+  void *p = c.take(a.size() * sizeof(T) + padding);
+  if (p && !a.empty()) std::memcpy(p, a.data(), a.size() * sizeof(T));
+}
+
+template <typename T> void adopt(Cursor &c, Mesh::Array<T> &a, const std::size_t n, const std::size_t padding = 0) {
+  T *p = static_cast<T *>(c.take(n * sizeof(T) + padding));
+  Mesh::Array<T> shared(MeshAllocator<T>(p, n));
+  shared.resize(n);
+  a.swap(shared);
+}
+
+/// copy a mesh into the window
+void write(Cursor &c, const Mesh &m) {
+  Record r;
+  r.count[VERTICES] = m.vertices.size();
+  r.count[MAPUV] = m.mapuv.size();
+  r.count[NORMALS] = m.normals.size();
+  r.count[FACES] = m.faces.size();
+  r.count[FACES_TO_NORMALS] = m.faces_to_normals.size();
+  r.count[FACE_NORMALS] = m.face_normals.size();
+  r.count[FACES_TO_MATERIALS] = m.faces_to_materials.size();
+  r.nmaterials = m.materials.size();
+  r.hasMat = m.mat != NULL;
+  if (m.mat) r.mat = *m.mat;
+  r.bounds_min = m.boundingBox.bounds_min;
+  r.bounds_max = m.boundingBox.bounds_max;
+  r.haveNormals = m.haveNormals;
+
+  void *p = c.take(sizeof(Record));
+  if (p) std::memcpy(p, &r, sizeof(Record));
+  Material *materials = static_cast<Material *>(c.take(m.materials.size() * sizeof(Material)));
+  unsigned char *present = static_cast<unsigned char *>(c.take(m.materials.size()));
+  for (std::size_t i = 0; materials && i < m.materials.size(); i++) {
+    present[i] = m.materials[i] != NULL;
+    if (m.materials[i]) materials[i] = *m.materials[i];
+  }
+  put(c, m.vertices, VERTEX_PADDING);
+  put(c, m.mapuv);
+  put(c, m.normals);
+  put(c, m.faces);
+  put(c, m.faces_to_normals);
+  put(c, m.face_normals);
+  put(c, m.faces_to_materials);
+}
+
+/// lay a mesh over the window, the rank that wrote it keeps its materials
+void lay(Cursor &c, Mesh &m, const bool writer) {
+  const Record &r = *static_cast<Record *>(c.take(sizeof(Record)));
+  const Material *materials = static_cast<Material *>(c.take(r.nmaterials * sizeof(Material)));
+  const unsigned char *present = static_cast<unsigned char *>(c.take(r.nmaterials));
+  if (!writer) {
+    m.mat = r.hasMat ? new Material(r.mat) : NULL;
+    m.materials.resize(r.nmaterials);
+    for (std::size_t i = 0; i < r.nmaterials; i++) m.materials[i] = present[i] ? new Material(materials[i]) : NULL;
+    m.boundingBox.bounds_min = r.bounds_min;
+    m.boundingBox.bounds_max = r.bounds_max;
+    m.haveNormals = r.haveNormals;
+  }
+  adopt(c, m.vertices, r.count[VERTICES], VERTEX_PADDING);
+  adopt(c, m.mapuv, r.count[MAPUV]);
+  adopt(c, m.normals, r.count[NORMALS]);
+  adopt(c, m.faces, r.count[FACES]);
+  adopt(c, m.faces_to_normals, r.count[FACES_TO_NORMALS]);
+  adopt(c, m.face_normals, r.count[FACE_NORMALS]);
+  adopt(c, m.faces_to_materials, r.count[FACES_TO_MATERIALS]);
+}
+
+MPI_Comm nodeComm = MPI_COMM_NULL;
+int nodeRank = 0;
+int nodeSize = 1;
+bool sharing = false;
+bool initialized = false;
+}
+
+MPI_Comm SharedMesh::node() {
+  if (!initialized) {
+    initialized = true;
+    int mpi = 0;
+    MPI_Initialized(&mpi);
+    if (mpi) {
+      int rank;
+      MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+      MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, rank, MPI_INFO_NULL, &nodeComm);
+      MPI_Comm_rank(nodeComm, &nodeRank);
+      MPI_Comm_size(nodeComm, &nodeSize);
+    }
+    const char *env = getenv("GVT_SHARED_MESH");
+    sharing = nodeSize > 1 && !(env && std::string(env) == "0");
+  }
+  return nodeComm;
+}
+
+bool SharedMesh::enabled() {
+  node();
+  return sharing;
+}
+
+bool SharedMesh::loads(std::size_t k) { return !enabled() || k % nodeSize == nodeRank; }
+
+void SharedMesh::share(gvt::core::Vector<Mesh *> &meshes) {
+  if (!enabled()) return;
+
+  // this rank segment holds the meshes it loaded, in order
+  Cursor measure(NULL);
+  for (std::size_t k = nodeRank; k < meshes.size(); k += nodeSize) write(measure, *meshes[k]);
+
+  MPI_Info info;
+  MPI_Info_create(&info);
+  MPI_Info_set(info, "alloc_shared_noncontig", "true");
+  char *mine = NULL;
+  MPI_Win win;
+  MPI_Win_allocate_shared(measure.offset, 1, info, nodeComm, &mine, &win);
+  MPI_Info_free(&info);
+
+  MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+  Cursor out(mine);
+  for (std::size_t k = nodeRank; k < meshes.size(); k += nodeSize) write(out, *meshes[k]);
+  MPI_Win_sync(win);
+  MPI_Barrier(nodeComm);
+  MPI_Win_sync(win);
+
+  gvt::core::Vector<Cursor> in;
+  for (int r = 0; r < nodeSize; r++) {
+    MPI_Aint size;
+    int disp;
+    char *base;
+    MPI_Win_shared_query(win, r, &size, &disp, &base);
+    in.push_back(Cursor(base));
+  }
+  for (std::size_t k = 0; k < meshes.size(); k++) {
+    const bool writer = (k % nodeSize == nodeRank);
+    if (!writer) meshes[k] = new Mesh();
+    lay(in[k % nodeSize], *meshes[k], writer);
+  }
+  MPI_Win_unlock_all(win);
+  // the window is never freed, the meshes use it until the end of the run
+}
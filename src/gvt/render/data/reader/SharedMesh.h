@@ -0,0 +1,71 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#ifndef GVT_RENDER_DATA_DOMAIN_READER_SHARED_MESH_H
+#define GVT_RENDER_DATA_DOMAIN_READER_SHARED_MESH_H
+
+#include <gvt/render/data/Primitives.h>
+
+#include <cstddef>
+#include <mpi.h>
+
+namespace gvt {
+namespace render {
+namespace data {
+namespace domain {
+namespace reader {
+/// replicated meshes kept once per compute node
+/** When every rank loads the same meshes (replicated domains, image scheduling), the ranks of a compute node
+share a single copy of the mesh arrays in a MPI-3 shared memory window. The meshes are split between the
+ranks of the node (loads), each rank reads its part and share() copies it into the rank segment of the
+window, then every rank lays its meshes over the window (Mesh::isShared) and the heap copies are freed.
+Per-rank data (materials, bounds) is copied, and the windows live until the end of the run.
+
+Sharing is used when the node runs several ranks, setting the GVT_SHARED_MESH environment variable to 0
+turns it off.
+*/
+class SharedMesh {
+public:
+  /// ranks sharing the compute node, collective over MPI_COMM_WORLD on the first call
+  static MPI_Comm node();
+
+  /// true if replicated meshes are shared by the ranks of the node, collective on the first call
+  static bool enabled();
+
+  /// true if this rank loads the k-th of the replicated meshes
+  static bool loads(std::size_t k);
+
+  /// share the replicated meshes across the node, collective over the node ranks
+  /** meshes[k] is loaded on the rank for which loads(k) is true and null on the others. On return every
+  entry is a mesh laid over the shared window. Does nothing unless enabled.
+  */
+  static void share(gvt::core::Vector<gvt::render::data::primitives::Mesh *> &meshes);
+};
+}
+}
+}
+}
+}
+
+#endif /* GVT_RENDER_DATA_DOMAIN_READER_SHARED_MESH_H */
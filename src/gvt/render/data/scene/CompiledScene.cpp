@@ -0,0 +1,139 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#include <gvt/render/data/scene/CompiledScene.h>
+
+#include <algorithm>
+
+using namespace gvt::core;
+using namespace gvt::render::data::primitives;
+using namespace gvt::render::data::scene;
+
+namespace {
+const Atom INSTANCES("Instances");
+const Atom ID("id");
+const Atom MESHREF("meshRef");
+const Atom BBOX("bbox");
+const Atom CENTROID("centroid");
+const Atom MAT("mat");
+const Atom MATINV("matInv");
+const Atom NORMI("normi");
+const Atom PTR("ptr");
+const Atom LOCATIONS("Locations");
+
+/// has the node or any of its descendants been assigned after the stamp
+bool newer(DBNodeH node, const std::size_t stamp) {
+  if (node.getNode().version() > stamp) return true;
+  for (DBNodeH &child : node.getChildren())
+    if (newer(child, stamp)) return true;
+  return false;
+}
+}
+
+CompiledScene::CompiledScene() {}
+
+void CompiledScene::clear() {
+  m.clear();
+  minv.clear();
+  normi.clear();
+  bounds.clear();
+  centroid.clear();
+  id.clear();
+  mesh.clear();
+  material.clear();
+  locations.clear();
+  instances.clear();
+  meshes.clear();
+  stamp = 0;
+}
+
+bool CompiledScene::update() {
+  CoreContext *ctx = CoreContext::instance();
+  if (stamp != 0 && DatabaseNode::now() == stamp) return false;
+
+  // compiling may create missing nodes, the stamp is taken afterwards so that does not count as a change
+  if (stamp == 0 || ctx->database()->structure() > stamp) {
+    compile();
+    stamp = DatabaseNode::now();
+    return true;
+  }
+
+  bool any = false;
+  for (size_t i = 0; i < instances.size(); i++) {
+    if (!changed(i)) continue;
+    compile(i);
+    any = true;
+  }
+  stamp = DatabaseNode::now();
+  return any;
+}
+
+bool CompiledScene::changed(const int i) { return newer(instances[i], stamp) || newer(meshes[i], stamp); }
+
+void CompiledScene::compile() {
+  instances = CoreContext::instance()->getRootNode()[INSTANCES].getChildren();
+  const size_t n = instances.size();
+  meshes.assign(n, DBNodeH());
+  m.resize(n);
+  minv.resize(n);
+  normi.resize(n);
+  bounds.resize(n);
+  centroid.resize(n);
+  id.resize(n);
+  mesh.resize(n);
+  material.resize(n);
+  locations.resize(n);
+  for (size_t i = 0; i < n; i++) compile(i);
+}
+
+void CompiledScene::compile(const int i) {
+  DBNodeH &inst = instances[i];
+  meshes[i] = inst[MESHREF].deRef();
+  id[i] = inst[ID].value().toInteger();
+
+  glm::mat4 *mp = (glm::mat4 *)inst[MAT].value().toULongLong();
+  glm::mat4 *minvp = (glm::mat4 *)inst[MATINV].value().toULongLong();
+  glm::mat3 *normip = (glm::mat3 *)inst[NORMI].value().toULongLong();
+  m[i] = mp ? *mp : glm::mat4(1.f);
+  minv[i] = minvp ? *minvp : glm::inverse(m[i]);
+  normi[i] = normip ? *normip : glm::transpose(glm::inverse(glm::mat3(m[i])));
+
+  Box3D *bbox = (Box3D *)inst[BBOX].value().toULongLong();
+  bounds[i] = bbox ? *bbox : Box3D();
+  centroid[i] = inst[CENTROID].value().tovec3();
+
+  mesh[i] = meshes[i].isValid() ? (Mesh *)meshes[i][PTR].value().toULongLong() : nullptr;
+  material[i] = mesh[i] ? mesh[i]->getMaterial() : nullptr;
+
+  locations[i].clear();
+  if (meshes[i].isValid()) {
+    for (DBNodeH &loc : meshes[i][LOCATIONS].getChildren()) locations[i].push_back(loc.value().toInteger());
+    std::sort(locations[i].begin(), locations[i].end());
+    locations[i].erase(std::unique(locations[i].begin(), locations[i].end()), locations[i].end());
+  }
+}
+
+bool CompiledScene::isLocatedIn(const int i, const int rank) const {
+  return std::binary_search(locations[i].begin(), locations[i].end(), rank);
+}
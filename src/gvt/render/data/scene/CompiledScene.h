@@ -0,0 +1,94 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#ifndef GVT_RENDER_DATA_SCENE_COMPILED_SCENE_H
+#define GVT_RENDER_DATA_SCENE_COMPILED_SCENE_H
+
+#include <gvt/core/Math.h>
+#include <gvt/core/context/CoreContext.h>
+#include <gvt/render/data/primitives/BBox.h>
+#include <gvt/render/data/primitives/Material.h>
+#include <gvt/render/data/primitives/Mesh.h>
+
+namespace gvt {
+namespace render {
+namespace data {
+namespace scene {
+
+/// typed snapshot of the scene instances stored in the context
+/**
+The context stores instances as database nodes holding pointers and uuids, so reading an
+instance matrix or bounding box means several name lookups and a variant conversion. The
+compiled scene copies everything the ray tracers need per instance into flat arrays indexed
+by the position of the instance under the "Instances" node (the index used by the queues,
+the BVH and the adapters).
+
+update() compares the context change stamps (DatabaseNode::version, Database::structure)
+with the stamp of the last compilation. If nodes were added, removed or renamed the scene is
+compiled from scratch, otherwise only the instances whose nodes (or mesh nodes) changed are
+recompiled. Matrices and boxes are copied, edits made in place through the stored pointers
+are only picked up after the owning node is assigned again.
+*/
+class CompiledScene {
+public:
+  CompiledScene();
+
+  /// bring the snapshot up to date with the context, returns true if any instance changed
+  bool update();
+  /// drop the snapshot, the next update compiles the whole scene
+  void clear();
+
+  /// number of instances
+  size_t size() const { return id.size(); }
+  /// is the mesh of instance i loaded in the given mpi rank
+  bool isLocatedIn(const int i, const int rank) const;
+
+  gvt::core::Vector<glm::mat4> m;                                 /**< Instance model matrix */
+  gvt::core::Vector<glm::mat4> minv;                              /**< Instance inverse model matrix */
+  gvt::core::Vector<glm::mat3> normi;                             /**< Instance normal matrix */
+  gvt::core::Vector<gvt::render::data::primitives::Box3D> bounds; /**< Instance world bounds */
+  gvt::core::Vector<glm::vec3> centroid;                          /**< Instance world bounds centroid */
+  gvt::core::Vector<int> id;                                      /**< Instance id stored in the context */
+  gvt::core::Vector<gvt::render::data::primitives::Mesh *> mesh;  /**< Instance mesh */
+  gvt::core::Vector<gvt::render::data::primitives::Material *> material; /**< Instance mesh material */
+  gvt::core::Vector<gvt::core::Vector<int> > locations; /**< Ranks where the instance mesh is loaded */
+
+private:
+  /// compile every instance under the "Instances" node
+  void compile();
+  /// copy instance i from the context
+  void compile(const int i);
+  /// has instance i (or its mesh) changed since the last compilation
+  bool changed(const int i);
+
+  gvt::core::Vector<gvt::core::DBNodeH> instances; /**< Instance nodes */
+  gvt::core::Vector<gvt::core::DBNodeH> meshes;    /**< Mesh node of each instance */
+  std::size_t stamp = 0;                           /**< Context change stamp of the last compilation */
+};
+}
+}
+}
+}
+
+#endif // GVT_RENDER_DATA_SCENE_COMPILED_SCENE_H
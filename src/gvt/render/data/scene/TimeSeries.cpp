@@ -0,0 +1,146 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#include <gvt/render/data/scene/TimeSeries.h>
+
+#include <mpi.h>
+#include <set>
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+using namespace gvt::core;
+using namespace gvt::render::data::primitives;
+using namespace gvt::render::data::scene;
+
+namespace {
+const Atom DATA("Data");
+const Atom INSTANCES("Instances");
+const Atom LOCATIONS("Locations");
+const Atom MESHREF("meshRef");
+const Atom BBOX("bbox");
+const Atom CENTROID("centroid");
+const Atom MAT("mat");
+const Atom PTR("ptr");
+}
+
+TimeSeries::TimeSeries(const Vector<std::string> &names, const int steps, Loader load, Callback prepare,
+                       Callback release, const int first)
+    : load(load), prepare(prepare), release(release), count(steps), current(first) {
+  int rank = 0;
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  std::set<std::string> wanted(names.begin(), names.end());
+  for (DBNodeH node : CoreContext::instance()->getRootNode()[DATA].getChildren()) {
+    const std::string name = node.value().toString();
+    if (!wanted.count(name)) continue;
+    bool here = false;
+    for (DBNodeH loc : node[LOCATIONS].getChildren()) here = here || loc.value().toInteger() == rank;
+    nodes.push_back(node);
+    this->names.push_back(name);
+    local.push_back(here);
+  }
+  next.assign(nodes.size(), nullptr);
+  shown.assign(nodes.size(), nullptr);
+  if (current + 1 < count) prefetch(current + 1);
+}
+
+TimeSeries::~TimeSeries() {
+  wait();
+  for (Mesh *m : next) {
+    if (m && release) release(m);
+    delete m;
+  }
+}
+
+void TimeSeries::prefetch(const int step) {
+  wait();
+  pending = step;
+  worker = std::thread([this, step]() {
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, names.size(), 1), [&](const tbb::blocked_range<size_t> &r) {
+      for (size_t i = r.begin(); i != r.end(); ++i) {
+        if (!local[i]) continue;
+        next[i] = load(names[i], step);
+        if (next[i] && prepare) prepare(next[i]);
+      }
+    });
+  });
+}
+
+void TimeSeries::wait() {
+  if (worker.joinable()) worker.join();
+}
+
+bool TimeSeries::advance() {
+  if (current + 1 >= count) return false;
+  if (pending != current + 1) prefetch(current + 1);
+  wait();
+
+  Vector<Mesh *> previous(nodes.size(), nullptr);
+  for (size_t i = 0; i < nodes.size(); i++)
+    if (local[i]) previous[i] = (Mesh *)nodes[i][PTR].value().toULongLong();
+  publish();
+
+  // the previous step is no longer referenced by the context, meshes the loader did not replace are kept
+  for (size_t i = 0; i < nodes.size(); i++) {
+    if (!next[i]) continue;
+    if (previous[i] && release) release(previous[i]);
+    delete shown[i];
+    shown[i] = next[i];
+    next[i] = nullptr;
+  }
+  current++;
+  pending = -1;
+  if (current + 1 < count) prefetch(current + 1);
+  return true;
+}
+
+void TimeSeries::publish() {
+  CoreContext *ctx = CoreContext::instance();
+  for (size_t i = 0; i < nodes.size(); i++) {
+    if (!local[i] || !next[i]) continue;
+    nodes[i][PTR] = (unsigned long long)next[i];
+    nodes[i][BBOX] = (unsigned long long)next[i]->getBoundingBox();
+    ctx->addToSync(nodes[i]);
+  }
+  ctx->syncContext();
+
+  // every rank now has the bounds of every mesh, the instance bounds are recomputed locally
+  std::set<Uuid> changed;
+  for (DBNodeH &node : nodes) changed.insert(node.UUID());
+  Vector<DBNodeH> instances;
+  for (DBNodeH inst : ctx->getRootNode()[INSTANCES].getChildren())
+    if (changed.count(inst[MESHREF].value().toUuid())) instances.push_back(inst);
+
+  Vector<Box3D> fresh;
+  fresh.reserve(instances.size());
+  for (DBNodeH &inst : instances) {
+    const glm::mat4 &m = *(glm::mat4 *)inst[MAT].value().toULongLong();
+    const Box3D &mbox = *(Box3D *)inst[MESHREF].deRef()[BBOX].value().toULongLong();
+    const glm::vec3 il(m * glm::vec4(mbox.bounds_min, 1.f));
+    const glm::vec3 ih(m * glm::vec4(mbox.bounds_max, 1.f));
+    fresh.push_back(Box3D(il, ih));
+    inst[BBOX] = (unsigned long long)&fresh.back();
+    inst[CENTROID] = fresh.back().centroid();
+  }
+  boxes.swap(fresh);
+}
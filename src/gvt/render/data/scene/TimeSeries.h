@@ -0,0 +1,104 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#ifndef GVT_RENDER_DATA_SCENE_TIME_SERIES_H
+#define GVT_RENDER_DATA_SCENE_TIME_SERIES_H
+
+#include <gvt/core/context/CoreContext.h>
+#include <gvt/render/data/primitives/BBox.h>
+#include <gvt/render/data/primitives/Mesh.h>
+
+#include <functional>
+#include <string>
+#include <thread>
+
+namespace gvt {
+namespace render {
+namespace data {
+namespace scene {
+
+/// double buffered playback of time varying meshes
+/**
+The meshes of a time series are replaced at every time step. While the current step is rendered a
+background thread loads the meshes of the next step and calls prepare on each of them (typically
+RayTracer::prepareAdapter, so the adapters are built in the background too). advance() waits for the
+next step and swaps it in between two frames: the mesh nodes are pointed at the new meshes, the context
+is synchronized, the bounds of the instances of these meshes are recomputed and the previous meshes are
+released and freed. At most two steps are in memory.
+
+Only the meshes located on this rank are loaded. The loader runs outside the main thread, it must not
+call MPI nor use the context. The context holds the first step when the series is created (loaded by
+the readers or the api), those meshes are left to their owner; the meshes loaded by the series are
+freed once replaced. The tracer has to be brought up to date after each advance (RayTracer::resetBVH).
+*/
+class TimeSeries {
+public:
+  /// load the mesh of a mesh node (by name) at a time step
+  typedef std::function<gvt::render::data::primitives::Mesh *(const std::string &name, const int step)> Loader;
+  typedef std::function<void(gvt::render::data::primitives::Mesh *)> Callback;
+
+  /// series of the named mesh nodes over steps time steps, the context holds step first
+  /** starts loading step first + 1 */
+  TimeSeries(const gvt::core::Vector<std::string> &names, const int steps, Loader load, Callback prepare = Callback(),
+             Callback release = Callback(), const int first = 0);
+  /// waits for the background thread and frees the pending step, the current step stays in the context
+  ~TimeSeries();
+
+  /// time step held by the context
+  int step() const { return current; }
+  /// number of time steps
+  int steps() const { return count; }
+
+  /// swap in the next time step, collective. Returns false after the last step (nothing changes)
+  bool advance();
+
+private:
+  /// load step in the background thread
+  void prefetch(const int step);
+  /// wait for the background thread
+  void wait();
+  /// point the mesh and instance nodes at the loaded meshes
+  void publish();
+
+  Loader load;
+  Callback prepare;
+  Callback release;
+  int count;
+  int current;
+  int pending = -1; /**< Step loaded by the background thread, -1 if none */
+  std::thread worker;
+
+  gvt::core::Vector<gvt::core::DBNodeH> nodes;                    /**< Mesh nodes of the series */
+  gvt::core::Vector<std::string> names;                           /**< Mesh node names */
+  gvt::core::Vector<bool> local;                                  /**< Is the mesh located on this rank */
+  gvt::core::Vector<gvt::render::data::primitives::Mesh *> next;  /**< Meshes of the pending step */
+  gvt::core::Vector<gvt::render::data::primitives::Mesh *> shown; /**< Meshes of the current step loaded here */
+  gvt::core::Vector<gvt::render::data::primitives::Box3D> boxes;  /**< Instance bounds of the current step */
+};
+}
+}
+}
+}
+
+#endif // GVT_RENDER_DATA_SCENE_TIME_SERIES_H
@@ -31,6 +31,11 @@
 #include <tbb/blocked_range.h>
 #include <tbb/parallel_for.h>
 #include <tbb/partitioner.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
 #include <thread>
 
 using namespace gvt::render::data::scene;
@@ -195,6 +200,10 @@ gvtPerspectiveCamera::~gvtPerspectiveCamera() {}
 // gvt::render::actor::RayVector gvtPerspectiveCamera::generateRays() {
 void gvtPerspectiveCamera::generateRays() {
   gvt::core::time::timer t(true, "generate camera rays");
+  generatePixelRays(nullptr, nullptr);
+}
+
+void gvtPerspectiveCamera::generatePixelRays(const unsigned char *mask, const size_t *row_offset) {
   // Generate rays direction in camera space and transform to world space.
   int buffer_width = filmsize[0];
   int buffer_height = filmsize[1];
@@ -207,8 +216,6 @@ void gvtPerspectiveCamera::generateRays() {
   const float vert = tanf(field_of_view * 0.5);
   const float horz = tanf(field_of_view * 0.5) * aspectRatio;
 
-  const glm::vec4 camera_normal_basis_vector(0, 0, 1, 0);
-
   const float divider = samples;
   const float offset = (1.0 / divider) * jitterWindowSize;
   const glm::vec3 z(cam2wrld[0][2], cam2wrld[1][2], cam2wrld[2][2]);
@@ -218,27 +225,23 @@ void gvtPerspectiveCamera::generateRays() {
   const float half_sample = samples * 0.5f;
   const size_t samples2 = samples * samples;
   const float contri = 1.f / (samples * samples);
-  // for (j = 0; j < buffer_height; j++)
-  //   for (i = 0; i < buffer_width; i++) {
-  const size_t chunksize =
-      buffer_height / (gvt::core::CoreContext::instance()->getRootNode()["threads"].value().toInteger() * 4);
+  const size_t chunksize = std::max(
+      1, buffer_height / (gvt::core::CoreContext::instance()->getRootNode()["threads"].value().toInteger() * 4));
   static tbb::auto_partitioner ap;
   tbb::parallel_for(tbb::blocked_range<size_t>(0, buffer_height, chunksize),
                     [&](tbb::blocked_range<size_t> &chunk) {
-                      gvt::core::math::RandEngine randEngine;
-                      randEngine.SetSeed(chunk.begin());
                       for (size_t j = chunk.begin(); j < chunk.end(); j++) {
                         // multi - jittered samples
-                        // int i = idx;
+                        size_t pidx = row_offset ? row_offset[j] : j * buffer_width;
                         int idx = j * buffer_width;
-                        for (size_t i = 0; i < buffer_width; i++) {
+                        for (size_t i = 0; i < buffer_width; i++, idx++) {
+                          if (mask && !mask[idx]) continue;
                           const float x0 = float(i) * wmult - 1.0, y0 = float(j) * hmult - 1.0;
                           float x, y;
-                          // glm::vec4 camera_space_ray_direction;
                           for (int k = 0; k < samples; k++) {
                             for (int w = 0; w < samples; w++) {
                               // calculate scale factors -1.0 < x,y < 1.0
-                              int ridx = idx * samples2 + k * samples + w;
+                              size_t ridx = pidx * samples2 + k * samples + w;
                               x = x0 + (w - half_sample) * offset; // + offset * (randEngine.fastrand(0, 1) - 0.5);
                               x *= horz;
                               y = y0 + (k - half_sample) * offset; // + offset * (randEngine.fastrand(0, 1) - 0.5);
@@ -258,10 +261,85 @@ void gvtPerspectiveCamera::generateRays() {
                               ray.depth = depth;
                             }
                           }
-                          idx++;
+                          pidx++;
                         }
                       }
                     },
                     ap);
 }
+
+bool gvtPerspectiveCamera::footprint(const gvt::render::data::primitives::Box3D &box, int &x0, int &y0, int &x1,
+                                     int &y1) {
+  const int buffer_width = filmsize[0];
+  const int buffer_height = filmsize[1];
+  const float aspectRatio = float(buffer_width) / float(buffer_height);
+  const float vert = tanf(field_of_view * 0.5);
+  const float horz = tanf(field_of_view * 0.5) * aspectRatio;
+  const float wmult = 2.f / float(buffer_width - 1);
+  const float hmult = 2.f / float(buffer_height - 1);
+
+  const glm::vec3 cu(cam2wrld[0][0], cam2wrld[1][0], cam2wrld[2][0]);
+  const glm::vec3 cv(cam2wrld[0][1], cam2wrld[1][1], cam2wrld[2][1]);
+  const glm::vec3 cw(cam2wrld[0][2], cam2wrld[1][2], cam2wrld[2][2]);
+
+  float xmin = FLT_MAX, ymin = FLT_MAX, xmax = -FLT_MAX, ymax = -FLT_MAX;
+  for (int c = 0; c < 8; c++) {
+    const glm::vec3 p((c & 1) ? box.bounds_max[0] : box.bounds_min[0], (c & 2) ? box.bounds_max[1] : box.bounds_min[1],
+                      (c & 4) ? box.bounds_max[2] : box.bounds_min[2]);
+    const glm::vec3 d = p - eye_point;
+    const float z = glm::dot(d, cw);
+    if (z <= gvt::render::actor::Ray::RAY_EPSILON) {
+      // corner behind the eye, the projection is unbounded
+      x0 = y0 = 0;
+      x1 = buffer_width - 1;
+      y1 = buffer_height - 1;
+      return true;
+    }
+    const float x = glm::dot(d, cu) / (z * horz);
+    const float y = glm::dot(d, cv) / (z * vert);
+    xmin = std::min(xmin, x);
+    xmax = std::max(xmax, x);
+    ymin = std::min(ymin, y);
+    ymax = std::max(ymax, y);
+  }
+
+  // film coordinates, with a margin to cover the pixel area and the jittered samples
+  const float jitter = samples * 0.5f * (1.0 / float(samples)) * jitterWindowSize;
+  const int mx = 1 + int(std::ceil(jitter / wmult));
+  const int my = 1 + int(std::ceil(jitter / hmult));
+  x0 = std::max(0, int(std::floor((xmin + 1.f) / wmult)) - mx);
+  y0 = std::max(0, int(std::floor((ymin + 1.f) / hmult)) - my);
+  x1 = std::min(buffer_width - 1, int(std::ceil((xmax + 1.f) / wmult)) + mx);
+  y1 = std::min(buffer_height - 1, int(std::ceil((ymax + 1.f) / hmult)) + my);
+  return x0 <= x1 && y0 <= y1;
+}
+
+void gvtPerspectiveCamera::generateRays(const gvt::core::Vector<gvt::render::data::primitives::Box3D> &boxes) {
+  gvt::core::time::timer t(true, "generate footprint camera rays");
+  const int buffer_width = filmsize[0];
+  const int buffer_height = filmsize[1];
+
+  // pixel mask with the union of the box footprints
+  gvt::core::Vector<unsigned char> mask(size_t(buffer_width) * buffer_height, 0);
+  for (auto &box : boxes) {
+    int x0, y0, x1, y1;
+    if (!footprint(box, x0, y0, x1, y1)) continue;
+    for (int j = y0; j <= y1; j++) std::memset(&mask[size_t(j) * buffer_width + x0], 1, x1 - x0 + 1);
+  }
+
+  // first ray of each film row
+  gvt::core::Vector<size_t> row_offset(buffer_height + 1, 0);
+  for (int j = 0; j < buffer_height; j++) {
+    size_t count = 0;
+    for (int i = 0; i < buffer_width; i++) count += mask[size_t(j) * buffer_width + i];
+    row_offset[j + 1] = row_offset[j] + count;
+  }
+
+  const size_t samples2 = samples * samples;
+  rays.clear();
+  rays.resize(row_offset[buffer_height] * samples2);
+  if (rays.empty()) return;
+  generatePixelRays(&mask[0], &row_offset[0]);
+}
+
 void gvtPerspectiveCamera::setFOV(const float fov) { field_of_view = fov; }
@@ -121,6 +121,15 @@ public:
   /** Fill the ray data structure */
   virtual void generateRays() = 0;
 
+  /** Fill the ray data structure only with the rays of the pixels covered by the screen footprint of a set of
+   * world space boxes. A pixel covered by several boxes is generated once. The base class generates the rays for
+   * the whole film.
+   */
+  virtual void generateRays(const gvt::core::Vector<gvt::render::data::primitives::Box3D> &boxes) {
+    AllocateCameraRays();
+    generateRays();
+  }
+
   /** Set the field of view angle in degrees*/
   virtual void setFOV(const float fov) = 0;
 
@@ -166,7 +175,21 @@ public:
   /** Fill the ray data structure */
   virtual void generateRays();
 
+  /** Generate the rays of the pixels covered by the projection of the boxes. The footprint of each box is
+   * the bounding rectangle of its projected corners, it covers the whole film if the box is behind or contains
+   * the eye point.
+   */
+  virtual void generateRays(const gvt::core::Vector<gvt::render::data::primitives::Box3D> &boxes);
+
 protected:
+  /** Project a world space box to the film, returns false if the box is not visible */
+  bool footprint(const gvt::render::data::primitives::Box3D &box, int &x0, int &y0, int &x1, int &y1);
+
+  /** Generate the samples of the pixels set in mask (all pixels if mask is null), the rays of row j start at
+   * pixel row_offset[j] of the ray vector (j * width if row_offset is null)
+   */
+  void generatePixelRays(const unsigned char *mask, const size_t *row_offset);
+
   float field_of_view; //!< Angle subtended by the film plane height from eye_point
 };
 
@@ -25,6 +25,7 @@
 #include <algorithm>
 
 #include "DomainTracer.h"
+#include "Messages/ReturnCredits.h"
 #include "Messages/SendRayList.h"
 #include <gvt/core/comm/communicator.h>
 #include <gvt/core/utils/global_counter.h>
@@ -32,61 +33,32 @@
 
 namespace gvt {
 namespace render {
-
-bool DomainTracer::areWeDone() {
-  std::shared_ptr<gvt::comm::communicator> comm = gvt::comm::communicator::singleton();
-  gvt::render::RenderContext &cntxt = *gvt::render::RenderContext::instance();
-  std::shared_ptr<DomainTracer> tracer = std::dynamic_pointer_cast<DomainTracer>(cntxt.tracer());
-  if (!tracer || tracer->getGlobalFrameFinished()) return false;
-  bool ret = tracer->isDone();
-  return ret;
+namespace {
+const gvt::core::Atom THREADS("threads");
 }
 
-void DomainTracer::Done(bool T) {
-  std::shared_ptr<gvt::comm::communicator> comm = gvt::comm::communicator::singleton();
-  gvt::render::RenderContext &cntxt = *gvt::render::RenderContext::instance();
-  std::shared_ptr<DomainTracer> tracer = std::dynamic_pointer_cast<DomainTracer>(cntxt.tracer());
-  if (!tracer) return;
-  if (T) {
-    // std::lock_guard<std::mutex> _lock(tracer->_queue._protect);
-    // tracer->_queue._queue.clear();
-    tracer->setGlobalFrameFinished(true);
-  }
-}
 DomainTracer::DomainTracer() : gvt::render::RayTracer() {
   RegisterMessage<gvt::comm::EmptyMessage>();
   RegisterMessage<gvt::comm::SendRayList>();
+  RegisterMessage<gvt::comm::ReturnCredits>();
   gvt::comm::communicator &comm = gvt::comm::communicator::instance();
-  v = std::make_shared<comm::vote::vote>(DomainTracer::areWeDone, DomainTracer::Done);
-  comm.setVote(v);
+  comm.enableSharedTransport();
+  td = std::make_shared<comm::termination::termination>();
+  comm.setTermination(td);
 
   queue_mutex = new std::mutex[meshRef.size()];
   for (auto &m : meshRef) {
     queue[m.first] = gvt::render::actor::RayVector();
   }
 
-  instances_in_node.clear();
-  gvt::core::Map<std::string, std::set<int> > remote_location;
+  locateInstances();
   gvt::core::DBNodeH rootnode = cntxt->getRootNode();
-  gvt::core::Vector<gvt::core::DBNodeH> dataNodes = rootnode["Data"].getChildren();
-  // build location map, where meshes are by mpi node
-  for (size_t i = 0; i < dataNodes.size(); i++) {
-    gvt::core::Vector<gvt::core::DBNodeH> locations = dataNodes[i]["Locations"].getChildren();
-    for (auto loc : locations) {
-      remote_location[dataNodes[i].UUID().toString()].insert(loc.value().toInteger());
-    }
-  }
-
-  gvt::core::Vector<gvt::core::DBNodeH> instancenodes = rootnode["Instances"].getChildren();
-  for (int i = 0; i < instancenodes.size(); i++) {
-    std::string UUID = instancenodes[i]["meshRef"].deRef().UUID().toString();
-    if (remote_location[UUID].find(comm.id()) != remote_location[UUID].end()) {
-      instances_in_node[i] = true;
-    } else {
-      instances_in_node[i] = false;
-      remote[i] = remote_location[UUID];
-    }
-  }
+  outgoing.configure(comm.lastid(), rootnode["Schedule"]["sendBatch"].value().toInteger(),
+                     rootnode["Schedule"]["sendTimeout"].value().toFloat(),
+                     rootnode["Schedule"]["sendCredits"].value().toInteger());
+  maxQueued = rootnode["Schedule"]["maxQueued"].value().toInteger();
+  owed.assign(comm.lastid(), 0);
+  setRouting(rootnode["Schedule"]["nodeRouting"].value().toBoolean());
 }
 
 DomainTracer::~DomainTracer() {
@@ -97,109 +69,112 @@ DomainTracer::~DomainTracer() {
 void DomainTracer::resetBVH() {
   RayTracer::resetBVH();
   if (queue_mutex != nullptr) delete[] queue_mutex;
+  queue_mutex = new std::mutex[meshRef.size()];
   for (auto &m : meshRef) {
     queue[m.first] = gvt::render::actor::RayVector();
     queue[m.first].reserve(8192);
   }
+  locateInstances();
+  gvt::core::DBNodeH schedule = cntxt->getRootNode()["Schedule"];
+  outgoing.configure(gvt::comm::communicator::instance().lastid(), schedule["sendBatch"].value().toInteger(),
+                     schedule["sendTimeout"].value().toFloat(), schedule["sendCredits"].value().toInteger());
+  maxQueued = schedule["maxQueued"].value().toInteger();
+  setRouting(schedule["nodeRouting"].value().toBoolean());
+  std::lock_guard<std::mutex> l(owed_mutex);
+  owed.assign(gvt::comm::communicator::instance().lastid(), 0);
 }
 
-void DomainTracer::operator()() {
+void DomainTracer::locateInstances() {
+  const int rank = gvt::comm::communicator::instance().id();
+  // where the meshes are loaded, by mpi node (compiled by RayTracer::resetBVH)
+  instances_in_node.clear();
+  remote.clear();
+  local_bounds.clear();
+  for (size_t i = 0; i < scene.size(); i++) {
+    if (scene.isLocatedIn(i, rank)) {
+      instances_in_node[i] = true;
+      local_bounds.push_back(scene.bounds[i]);
+    } else {
+      instances_in_node[i] = false;
+      remote[i] = std::set<int>(scene.locations[i].begin(), scene.locations[i].end());
+    }
+    queuePriority.setSchedulable(i, instances_in_node[i]);
+  }
+}
+
+void DomainTracer::setRouting(const bool nodeRouting) {
   gvt::comm::communicator &comm = gvt::comm::communicator::instance();
+  hop.resize(comm.lastid());
+  for (int n = 0; n < hop.size(); n++) hop[n] = nodeRouting ? comm.gateway(n) : n;
+}
+
+void DomainTracer::operator()() {
   _GlobalFrameFinished = false;
 
   gvt::core::time::timer t_frame(true, "domain tracer: frame :");
   gvt::core::time::timer t_all(false, "domain tracer: all timers :");
   gvt::core::time::timer t_gather(false, "domain tracer: gather :");
   gvt::core::time::timer t_send(false, "domain tracer: send :");
-  gvt::core::time::timer t_shuffle(false, "domain tracer: shuffle :");
-  gvt::core::time::timer t_tracer(false, "domain tracer: adapter+tracer :");
+  gvt::core::time::timer t_tracer(false, "domain tracer: adapter+tracer+shuffle :");
   gvt::core::time::timer t_select(false, "domain tracer: select :");
   gvt::core::time::timer t_filter(false, "domain tracer: filter :");
   gvt::core::time::timer t_camera(false, "domain tracer: gen rays :");
 
   gvt::util::global_counter gc_rays("Number of rays traced :");
   gvt::util::global_counter gc_filter("Number of rays filtered :");
-  gvt::util::global_counter gc_shuffle("Number of rays shuffled :");
   gvt::util::global_counter gc_sent("Number of rays sent :");
+  gvt::util::global_counter gc_stalls("Number of ray messages held back by flow control :");
 
   img->reset();
   t_camera.resume();
-  cam->AllocateCameraRays();
-  cam->generateRays();
+  cam->generateRays(local_bounds);
   t_camera.stop();
   t_filter.resume();
   gc_filter.add(cam->rays.size());
   processRaysAndDrop(cam->rays);
   t_filter.stop();
-  gvt::render::actor::RayVector returned_rays;
+  gvt::core::Vector<int> targets;
 
   do {
-    int target = -1;
-    int amount = 0;
     t_select.resume();
-    for (auto &q : queue) {
-      if (isInNode(q.first) && q.second.size() > amount) {
-        amount = q.second.size();
-        target = q.first;
-      }
-    }
+    selectQueues(targets);
     t_select.stop();
 
-    if (target != -1) {
-      gvt::render::actor::RayVector tmp;
-
-      queue_mutex[target].lock();
+    if (!targets.empty()) {
       t_tracer.resume();
-      gc_rays.add(queue[target].size());
-      std::swap(queue[target], tmp);
-      queue[target].reserve(4096);
-      queue_mutex[target].unlock();
-      RayTracer::calladapter(target, tmp, returned_rays);
+      gc_rays.add(traceQueues(targets));
       t_tracer.stop();
-
-      t_shuffle.resume();
-      gc_shuffle.add(returned_rays.size());
-      processRays(returned_rays, target);
-      t_shuffle.stop();
     }
 
-    if (target == -1) {
-      t_send.resume();
-      for (auto &q : queue) {
-        if (isInNode(q.first) || q.second.empty()) continue;
-        queue_mutex[q.first].lock();
-        gc_sent.add(q.second.size());
-        int sendto = pickNode(q.first);
-        std::shared_ptr<gvt::comm::Message> msg = std::make_shared<gvt::comm::SendRayList>(comm.id(), sendto, q.second);
-        comm.send(msg, sendto);
-
-        q.second.clear();
-        queue_mutex[q.first].unlock();
-      }
-      t_send.stop();
-    }
+    t_send.resume();
+    if (targets.empty())
+      outgoing.flush();
+    else
+      outgoing.poll();
+    gc_sent.add(outgoing.sent());
+    gc_stalls.add(outgoing.stalls());
+    returnCredits();
+    t_send.stop();
 
-    if (isDone()) {
-      v->PorposeVoting();
-    }
+    if (td->progress(isDone())) _GlobalFrameFinished = true;
 
   } while (hasWork());
   t_gather.resume();
   img->composite();
   t_gather.stop();
   t_frame.stop();
-  t_all = t_gather + t_send + t_shuffle + t_tracer + t_filter + t_select;
+  t_all = t_gather + t_send + t_tracer + t_filter + t_select;
   gc_filter.print();
-  gc_shuffle.print();
   gc_rays.print();
   gc_sent.print();
+  gc_stalls.print();
 }
 
 inline void DomainTracer::processRaysAndDrop(gvt::render::actor::RayVector &rays) {
 
   gvt::comm::communicator &comm = gvt::comm::communicator::instance();
   const int chunksize =
-      MAX(4096, rays.size() / (gvt::core::CoreContext::instance()->getRootNode()["threads"].value().toInteger() * 4));
+      MAX(4096, rays.size() / (gvt::core::CoreContext::instance()->getRootNode()[THREADS].value().toInteger() * 4));
   gvt::render::data::accel::BVH &acc = *bvh.get();
   static tbb::auto_partitioner ap;
   tbb::parallel_for(tbb::blocked_range<gvt::render::actor::RayVector::iterator>(rays.begin(), rays.end(), chunksize),
@@ -214,13 +189,7 @@ inline void DomainTracer::processRaysAndDrop(gvt::render::actor::RayVector &rays
                         if (hits[i].next != -1)
                           if (instances_in_node[hits[i].next]) local_queue[hits[i].next].push_back(r);
                       }
-                      for (auto &q : local_queue) {
-                        queue_mutex[q.first].lock();
-                        queue[q.first].insert(queue[q.first].end(),
-                                              std::make_move_iterator(local_queue[q.first].begin()),
-                                              std::make_move_iterator(local_queue[q.first].end()));
-                        queue_mutex[q.first].unlock();
-                      }
+                      for (auto &q : local_queue) enqueue(q.first, q.second);
                     },
                     ap);
 
@@ -228,13 +197,20 @@ inline void DomainTracer::processRaysAndDrop(gvt::render::actor::RayVector &rays
 }
 
 inline void DomainTracer::processRays(gvt::render::actor::RayVector &rays, const int src, const int dst) {
+  if (rays.empty()) return;
+  processRays(&rays[0], &rays[0] + rays.size(), src);
+  rays.clear();
+}
+
+void DomainTracer::processRays(gvt::render::actor::Ray *begin, gvt::render::actor::Ray *end, const int src,
+                               const bool eager) {
 
   const int chunksize =
-      MAX(4096, rays.size() / (gvt::core::CoreContext::instance()->getRootNode()["threads"].value().toInteger() * 4));
+      MAX(4096, (end - begin) / (gvt::core::CoreContext::instance()->getRootNode()[THREADS].value().toInteger() * 4));
   gvt::render::data::accel::BVH &acc = *bvh.get();
   static tbb::auto_partitioner ap;
-  tbb::parallel_for(tbb::blocked_range<gvt::render::actor::RayVector::iterator>(rays.begin(), rays.end(), chunksize),
-                    [&](tbb::blocked_range<gvt::render::actor::RayVector::iterator> raysit) {
+  tbb::parallel_for(tbb::blocked_range<gvt::render::actor::Ray *>(begin, end, chunksize),
+                    [&](tbb::blocked_range<gvt::render::actor::Ray *> raysit) {
 
                       gvt::core::Vector<gvt::render::data::accel::BVH::hit> hits =
                           acc.intersect<GVT_SIMD_WIDTH>(raysit.begin(), raysit.end(), src);
@@ -250,28 +226,53 @@ inline void DomainTracer::processRays(gvt::render::actor::RayVector &rays, const
                         }
                       }
                       for (auto &q : local_queue) {
-                        queue_mutex[q.first].lock();
-                        queue[q.first].insert(queue[q.first].end(),
-                                              std::make_move_iterator(local_queue[q.first].begin()),
-                                              std::make_move_iterator(local_queue[q.first].end()));
-                        queue_mutex[q.first].unlock();
+                        if (isInNode(q.first))
+                          enqueue(q.first, q.second);
+                        else
+                          outgoing.append(hop[pickNode(q.first)], &q.second[0], &q.second[0] + q.second.size(),
+                                          eager);
                       }
                     },
                     ap);
-
-  rays.clear();
 }
 
 bool DomainTracer::MessageManager(std::shared_ptr<gvt::comm::Message> msg) {
-  std::shared_ptr<gvt::comm::communicator> comm = gvt::comm::communicator::singleton();
-  gvt::render::actor::RayVector rays;
-  rays.resize(msg->size() / sizeof(gvt::render::actor::Ray));
-  std::memcpy(&rays[0], msg->getMessage<void>(), msg->size());
-  processRays(rays);
+  if (msg->tag() == gvt::comm::ReturnCredits::COMMUNICATOR_MESSAGE_TAG) {
+    outgoing.grant(msg->src(), *msg->getMessage<std::size_t>());
+    return true;
+  }
+  gvt::render::actor::Ray *rays = msg->getMessage<gvt::render::actor::Ray>();
+  const size_t n = msg->sizehas<gvt::render::actor::Ray>();
+  processRays(rays, rays + n, -1, false);
+  std::lock_guard<std::mutex> l(owed_mutex);
+  owed[msg->src()] += n;
   return true;
 }
 
+void DomainTracer::returnCredits() {
+  if (queuePriority.queued() > maxQueued) return;
+
+  gvt::core::Vector<size_t> give;
+  {
+    std::lock_guard<std::mutex> l(owed_mutex);
+    give = owed;
+    std::fill(owed.begin(), owed.end(), 0);
+  }
+  gvt::comm::communicator &comm = gvt::comm::communicator::instance();
+  for (size_t node = 0; node < give.size(); node++) {
+    if (give[node] == 0) continue;
+    std::shared_ptr<gvt::comm::Message> msg = std::make_shared<gvt::comm::ReturnCredits>(give[node]);
+    comm.send(msg, node);
+  }
+}
+
 bool DomainTracer::isDone() {
+  if (!outgoing.empty()) return false;
+  {
+    std::lock_guard<std::mutex> l(owed_mutex);
+    for (auto &n : owed)
+      if (n > 0) return false;
+  }
   if (queue.empty()) return true;
   for (auto &q : queue)
     if (!q.second.empty()) return false;
@@ -25,6 +25,7 @@
 #ifndef GVT_RENDER_DOMAINTRACER
 #define GVT_RENDER_DOMAINTRACER
 
+#include <gvt/render/tracer/Domain/RayAggregator.h>
 #include <gvt/render/tracer/RayTracer.h>
 #include <mutex>
 #include <set>
@@ -48,9 +49,15 @@ private:
 protected:
   gvt::core::Map<int, std::set<int> > remote;  /**< Maps instances ids to their remote nodes */
   gvt::core::Map<int, bool> instances_in_node; /**< Determines if an instance (mesh) is available in the current node */
+  gvt::core::Vector<gvt::render::data::primitives::Box3D> local_bounds; /**< World bounds of the instances in node */
+  RayAggregator outgoing; /**< Rays bound to remote instances, coalesced per destination node */
+  gvt::core::Vector<size_t> owed; /**< Rays received from each node whose credits were not returned yet */
+  std::mutex owed_mutex;          /**< Protects owed (updated by the communication thread) */
+  size_t maxQueued = 1 << 20;     /**< Credits are withheld while the local queues hold more rays than this */
+  gvt::core::Vector<int> hop;     /**< Rank the rays bound to each node are sent to (@see setRouting) */
 
-  std::shared_ptr<comm::vote::vote> v;        /**< Voting procedure */
-  volatile bool _GlobalFrameFinished = false; /**< Communicates the result of the voting to the scheduler */
+  std::shared_ptr<comm::termination::termination> td; /**< Distributed termination detection */
+  volatile bool _GlobalFrameFinished = false;         /**< True when all nodes finished the current frame */
 
 public:
   DomainTracer();
@@ -58,9 +65,10 @@ public:
   /**
    * \brief Domain decomposition implementatiom
    *
-   * Determines the highest queue (highest ray count) and schedules it. If there are rays in instance queues that are
-   * only available in remote nodes, it encapsulates the queue in a send ray list message and delivers the message to
-   * the communicator to be sent.
+   * Selects the local queues with the highest ray count and traces them concurrently (@see
+   * RayTracer::traceQueues). Rays bound to instances that are only available in remote nodes never enter a queue,
+   * processRays streams them to the owner node through the ray aggregator. When there is no local work all pending
+   * messages are flushed.
    *
    * At the end invokes the Image Composition procedure that computes the final image buffer.
    *
@@ -70,6 +78,10 @@ public:
   /**
    * \brief Filters all the rays generated by the camera.
    *
+   * The camera only generates the rays covering the screen footprint of the instances in the node. A ray whose
+   * first hit is a remote instance is also generated by the node that owns the instance, since the ray crosses the
+   * instance footprint.
+   *
    * It moves the rays to queue of first instance intersection if that instance is available in the compute node,
    * otherwize drops the ray.
    *
@@ -81,14 +93,29 @@ public:
    * \brief Processes the ray returned by the adapter
    *
    * Sorts the arrays into there respective instance queues or computes their contribution to the final image by
-   * accumulating locally.
+   * accumulating locally. Rays that hit a remote instance first are appended to the outgoing message of the node
+   * that owns it.
    *
    *
    */
   void processRays(gvt::render::actor::RayVector &rays, const int src = -1, const int dst = -1);
   /**
-   * Process incomming user messages, in this case SendRayList. After extracting the ray queue invokes processRays to
-   * place them in the correct instance queue.
+   * \brief Processes a contiguous range of rays in place
+   *
+   * Same as processRays but the range is not cleared, which allows processing rays held in a message buffer.
+   *
+   * @param begin First ray
+   * @param end   One past the last ray
+   * @param src   Instance the rays come from (-1 if none)
+   * @param eager Allow sending the rays bound to remote nodes from the calling thread (@see RayAggregator::append)
+   */
+  void processRays(gvt::render::actor::Ray *begin, gvt::render::actor::Ray *end, const int src = -1,
+                   const bool eager = true);
+  /**
+   * Process incomming user messages, in this case SendRayList and ReturnCredits. The rays are processed directly from
+   * the received message buffer and placed in the correct instance queue, the buffer returns to the communication pool
+   * when the message is released. The credits for the rays are owed to the sender until returnCredits gives them
+   * back.
    *
    * Any other user message is passed to the parents method, to allow easy extension.
    *
@@ -98,6 +125,14 @@ public:
    */
   bool MessageManager(std::shared_ptr<gvt::comm::Message> msg);
 
+  /**
+   * \brief Return the credits owed to the nodes that sent us rays
+   *
+   * Credits are only returned while the local instance queues hold less than the Schedule maxQueued rays, so a node
+   * that is slow to trace stops receiving rays and its memory stays bounded.
+   */
+  void returnCredits();
+
   /**
    * Checks if there is not more work in the local queues and if the communicator has no more messages to deliver
    * @method isDone
@@ -116,7 +151,24 @@ public:
    * @method resetBVH
    */
   void resetBVH();
+  /**
+   * \brief Rebuild the location of the instances from the compiled scene
+   *
+   * Fills instances_in_node, remote and local_bounds and marks the local instance queues schedulable.
+   */
+  void locateInstances();
 
+  /**
+   * \brief Set the next hop of the rays bound to each node
+   *
+   * Without node routing rays are sent straight to the node that owns their next instance. With node routing (Schedule
+   * nodeRouting) rays bound to a rank in another compute node are sent to a single gateway rank of that compute node
+   * (@see gvt::comm::communicator::gateway), so each rank aggregates one message stream per compute node instead of
+   * one per rank. The gateway sorts the rays again and forwards them to the owner ranks through shared memory.
+   *
+   * @param nodeRouting Enable the two level routing
+   */
+  void setRouting(const bool nodeRouting);
   /**
    * \brief Check if an instance data is available in node
    * @method isInNode
@@ -127,35 +179,37 @@ public:
 
   /**
    * \brief Pick a remote node that contains the data for a given instance
+   *
+   * If the instance is replicated in several nodes, picks a node in the same compute node if there is one (which also
+   * bounds the forwarding of routed rays to one hop) and among those the one with most flow control credits
+   * available.
+   *
    * @method pickNode
    * @param  i        Instance internal id
    * @return          Remote node id
    */
-  inline int pickNode(const int &i) { return *remote[i].begin(); }
-
-  /**
-   * \brief Static method that allows the voting procedure to invoke the schedule isDone
-   * @method areWeDone
-   * @return true if no more work available
-   */
-  static bool areWeDone();
-
-  /**
-   * Static method used by the voting procedure to set the agreement value in the scheduler
-   * @method Done
-   * @param  bool [description]
-   */
-  static void Done(bool);
+  inline int pickNode(const int &i) {
+    const std::set<int> &nodes = remote[i];
+    int best = *nodes.begin();
+    if (nodes.size() == 1) return best;
+    gvt::comm::communicator &comm = gvt::comm::communicator::instance();
+    const int me = comm.id();
+    for (const int n : nodes) {
+      const bool near = comm.sameNode(me, n), bestNear = comm.sameNode(me, best);
+      if ((near && !bestNear) || (near == bestNear && outgoing.credits(hop[n]) > outgoing.credits(hop[best]))) best = n;
+    }
+    return best;
+  }
 
   /**
-   * \brief Allows the static voting procedure to set the communication flag to the scheduler
-   * \param v Value of the voting result (true if all agree that the work is finished)
+   * \brief Set the frame finished flag
+   * \param v True if all nodes finished the current frame
   */
   void inline setGlobalFrameFinished(bool v) { _GlobalFrameFinished = v; }
   /**
-   * Get the current agreement value for all the nodes
+   * Get the frame finished flag
    * @method getGlobalFrameFinished
-   * @return Current agreement value
+   * @return True if all nodes finished the current frame
    */
   bool inline getGlobalFrameFinished() { return _GlobalFrameFinished; }
 };
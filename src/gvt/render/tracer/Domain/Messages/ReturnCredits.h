@@ -0,0 +1,62 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards
+   ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   =======================================================================================
+   */
+
+#ifndef GVT_DOMAIN_RETURN_CREDITS_H
+#define GVT_DOMAIN_RETURN_CREDITS_H
+
+#include <gvt/core/comm/message.h>
+
+namespace gvt {
+namespace comm {
+/**
+ * @brief Return flow control credits message
+ *
+ * Sent by a node to a sender of rays once the rays it received were traced (or at least no longer held in the
+ * instance queues), allowing the sender to send that number of rays again.
+ *
+ */
+struct ReturnCredits : public gvt::comm::Message {
+  REGISTERABLE_MESSAGE(ReturnCredits);
+
+public:
+  /**
+   * @brief Default constructor
+   */
+  ReturnCredits() : gvt::comm::Message(sizeof(std::size_t)) { tag(COMMUNICATOR_MESSAGE_TAG); };
+  /**
+   * @brief Create a message returning a number of rays
+   * @param rays Number of rays returned
+   */
+  ReturnCredits(const std::size_t rays);
+  /**
+   * @brief Number of rays returned
+   */
+  std::size_t rays() { return *getMessage<std::size_t>(); }
+};
+}
+}
+
+#endif /*GVT_DOMAIN_RETURN_CREDITS_H*/
@@ -37,7 +37,7 @@ SendRayList::SendRayList(const long _src, const long _dst, gvt::render::actor::R
   tag(COMMUNICATOR_MESSAGE_TAG);
   src(_src);
   dst(_dst);
-  std::memcpy(getMessage<void>(), &raylist[0], sizeof(gvt::render::actor::Ray) * raylist.size());
+  if (!raylist.empty()) std::memcpy(getMessage<void>(), &raylist[0], sizeof(gvt::render::actor::Ray) * raylist.size());
 
   // std::size_t size = ;
   // _buffer = make_shared_buffer<unsigned char>(size + sizeof(long));
@@ -50,13 +50,13 @@ public:
     /**
      * @brief Default constructor
      */
-  SendRayList() : gvt::comm::Message(){};
+  SendRayList() : gvt::comm::Message() { tag(COMMUNICATOR_MESSAGE_TAG); };
   /**
    * @brief Create a message with a buffer of n size(bytes)
    */
-  SendRayList(const size_t &n) : gvt::comm::Message(n){};
+  SendRayList(const size_t &n) : gvt::comm::Message(n) { tag(COMMUNICATOR_MESSAGE_TAG); };
   /**
-   * @brief Create a message and copyt the ray list to the message buffer
+   * @brief Create a message and serialize the ray list directly into the (pooled) message buffer
    * @param src The origin compute node id
    * @param dst The destination compute node id
    * @param raylist The list of rays to send
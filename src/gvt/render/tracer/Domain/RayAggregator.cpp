@@ -0,0 +1,130 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+#include "RayAggregator.h"
+#include "Messages/SendRayList.h"
+
+#include <gvt/core/comm/communicator.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace gvt {
+namespace render {
+
+void RayAggregator::configure(const size_t nodes, const size_t t, const double to, const size_t c) {
+  threshold = std::max((size_t)1, t);
+  timeout = to;
+  budget = std::max((size_t)1, c);
+  slots.clear();
+  for (size_t i = 0; i < nodes; i++) {
+    slots.push_back(std::unique_ptr<slot>(new slot()));
+    slots.back()->credits = budget;
+  }
+  pending = 0;
+}
+
+void RayAggregator::append(const int dst, const gvt::render::actor::Ray *begin, const gvt::render::actor::Ray *end,
+                           const bool eager) {
+  const size_t n = end - begin;
+  if (n == 0) return;
+  slot &s = *slots[dst];
+  gvt::core::Vector<std::shared_ptr<gvt::comm::Message> > out;
+  {
+    std::lock_guard<std::mutex> l(s.m);
+    if (!s.msg) {
+      s.msg = std::make_shared<gvt::comm::SendRayList>(std::max(threshold, n) * sizeof(gvt::render::actor::Ray));
+      s.msg->resize(0);
+      s.rays = 0;
+      s.first = clock::now();
+    }
+    s.msg->resize((s.rays + n) * sizeof(gvt::render::actor::Ray));
+    std::memcpy(s.msg->getMessage<gvt::render::actor::Ray>() + s.rays, begin, n * sizeof(gvt::render::actor::Ray));
+    s.rays += n;
+    pending += n;
+    if (eager && ready(s, clock::now())) {
+      close(s);
+      release(s, out);
+    }
+  }
+  send(dst, out);
+}
+
+void RayAggregator::poll() {
+  const clock::time_point now = clock::now();
+  for (size_t dst = 0; dst < slots.size(); dst++) {
+    slot &s = *slots[dst];
+    gvt::core::Vector<std::shared_ptr<gvt::comm::Message> > out;
+    {
+      std::lock_guard<std::mutex> l(s.m);
+      if (ready(s, now)) close(s);
+      release(s, out);
+    }
+    send(dst, out);
+  }
+}
+
+void RayAggregator::flush() {
+  for (size_t dst = 0; dst < slots.size(); dst++) {
+    slot &s = *slots[dst];
+    gvt::core::Vector<std::shared_ptr<gvt::comm::Message> > out;
+    {
+      std::lock_guard<std::mutex> l(s.m);
+      if (s.rays > 0) close(s);
+      release(s, out);
+    }
+    send(dst, out);
+  }
+}
+
+void RayAggregator::grant(const int dst, const size_t rays) { slots[dst]->credits += rays; }
+
+void RayAggregator::close(slot &s) {
+  if (!s.msg) return;
+  s.backlog.push_back(s.msg);
+  if (s.backlog.size() > 1 || s.credits < (long)s.rays) messages_stalled++;
+  s.msg = nullptr;
+  s.rays = 0;
+}
+
+void RayAggregator::release(slot &s, gvt::core::Vector<std::shared_ptr<gvt::comm::Message> > &out) {
+  while (!s.backlog.empty()) {
+    const long n = s.backlog.front()->sizehas<gvt::render::actor::Ray>();
+    // a message larger than the budget is sent alone, once nothing else is in flight
+    if (s.credits < n && s.credits < budget) break;
+    s.credits -= n;
+    out.push_back(s.backlog.front());
+    s.backlog.pop_front();
+  }
+}
+
+void RayAggregator::send(const int dst, gvt::core::Vector<std::shared_ptr<gvt::comm::Message> > &msgs) {
+  for (auto &msg : msgs) {
+    const size_t n = msg->sizehas<gvt::render::actor::Ray>();
+    gvt::comm::communicator::instance().send(msg, dst);
+    rays_sent += n;
+    pending -= n;
+  }
+}
+}
+}
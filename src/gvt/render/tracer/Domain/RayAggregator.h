@@ -0,0 +1,173 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+#ifndef GVT_RENDER_RAY_AGGREGATOR
+#define GVT_RENDER_RAY_AGGREGATOR
+
+#include <gvt/core/comm/message.h>
+#include <gvt/render/actor/Ray.h>
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace gvt {
+namespace render {
+
+/**
+ * \brief Per destination coalescing of outgoing rays
+ *
+ * Rays bound to remote instances are appended, as soon as they are produced, to a send ray list message per
+ * destination node that is built in place in a pooled buffer. A message is sent as soon as it holds the configured
+ * number of rays or its oldest ray waited longer than the configured timeout, so remote nodes receive a steady stream
+ * of medium sized messages while the local node is still tracing. All rays to the same node share a message
+ * regardless of their target instance, the receiver sorts them with its own BVH.
+ *
+ * Outgoing traffic is flow controlled with credits. Each destination grants the node a budget of rays in flight
+ * (rays sent and not yet returned with grant). A message that does not fit in the remaining credits is kept in a
+ * local backlog until the destination returns credits, so the memory a node can push onto another one is bounded by
+ * the budget (or a single message if the message is larger than the budget).
+ *
+ * Append may be invoked concurrently by the tracing tasks.
+ */
+class RayAggregator {
+public:
+  typedef std::chrono::high_resolution_clock clock;
+
+  RayAggregator() {}
+
+  /**
+   * \brief Set the number of destinations, the flush policy and the credits, pending rays are discarded
+   * @param nodes     Number of compute nodes
+   * @param threshold Number of rays that triggers the send of a message
+   * @param timeout   Maximum time (ms) a ray waits in a message before it is sent
+   * @param credits   Maximum number of rays in flight to each destination
+   */
+  void configure(const size_t nodes, const size_t threshold, const double timeout, const size_t credits);
+
+  /**
+   * \brief Append rays to the message of a destination node
+   *
+   * Sends the message if it reached the size threshold or the timeout expired and the destination has credits. The
+   * communication thread must not send (a blocking send from the thread that receives may deadlock two nodes), it
+   * appends with eager set to false and leaves the message to the next poll or flush.
+   *
+   * @param dst   Destination compute node
+   * @param begin First ray
+   * @param end   One past the last ray
+   * @param eager Send the message from the calling thread if it is ready
+   */
+  void append(const int dst, const gvt::render::actor::Ray *begin, const gvt::render::actor::Ray *end,
+              const bool eager = true);
+
+  /**
+   * \brief Send the messages that are full or whose timeout expired, as far as the credits allow
+   */
+  void poll();
+
+  /**
+   * \brief Send all pending messages, as far as the credits allow
+   */
+  void flush();
+
+  /**
+   * \brief Return credits of a destination node
+   *
+   * Does not send, the backlog is sent by the next poll or flush (this is invoked by the communication thread).
+   *
+   * @param dst  Destination compute node that returned the credits
+   * @param rays Number of rays the destination finished with
+   */
+  void grant(const int dst, const size_t rays);
+
+  /**
+   * \brief Number of rays that can still be sent to a destination node
+   */
+  long credits(const int dst) const { return slots[dst]->credits; }
+
+  /**
+   * \brief True if there are no pending rays
+   */
+  bool empty() const { return pending == 0; }
+
+  /**
+   * \brief Number of rays sent since the last call (used for statistics)
+   */
+  size_t sent() { return rays_sent.exchange(0); }
+
+  /**
+   * \brief Number of messages held back for lack of credits since the last call (used for statistics)
+   */
+  size_t stalls() { return messages_stalled.exchange(0); }
+
+protected:
+  /**
+   * \brief Message being built for a destination node
+   */
+  struct slot {
+    std::mutex m;                                             /**< Slot protection */
+    std::shared_ptr<gvt::comm::Message> msg;                  /**< Message being built (nullptr if none) */
+    size_t rays = 0;                                          /**< Number of rays in the message */
+    clock::time_point first;                                  /**< Time the first ray was appended */
+    std::deque<std::shared_ptr<gvt::comm::Message> > backlog; /**< Messages waiting for credits */
+    std::atomic<long> credits{ 0 };                           /**< Rays that can still be sent */
+  };
+
+  /**
+   * \brief Move the message being built to the backlog, the caller must hold the slot lock
+   */
+  void close(slot &s);
+  /**
+   * \brief Take the backlog messages that fit in the credits, the caller must hold the slot lock
+   */
+  void release(slot &s, gvt::core::Vector<std::shared_ptr<gvt::comm::Message> > &out);
+  /**
+   * \brief Send messages released from the slot of node dst
+   */
+  void send(const int dst, gvt::core::Vector<std::shared_ptr<gvt::comm::Message> > &msgs);
+  /**
+   * \brief True if the oldest ray of a slot waited longer than the timeout
+   */
+  bool expired(const slot &s, const clock::time_point &now) const {
+    return s.rays > 0 && std::chrono::duration<double, std::milli>(now - s.first).count() >= timeout;
+  }
+  /**
+   * \brief True if the slot message must be sent
+   */
+  bool ready(const slot &s, const clock::time_point &now) const { return s.rays >= threshold || expired(s, now); }
+
+  std::vector<std::unique_ptr<slot> > slots; /**< One slot per destination node */
+  size_t threshold = 4096;                   /**< Rays per message that triggers a send */
+  double timeout = 1.;                       /**< Maximum time (ms) a ray waits to be sent */
+  long budget = 65536;                       /**< Rays in flight allowed per destination */
+  std::atomic<size_t> pending{ 0 };          /**< Rays appended but not sent */
+  std::atomic<size_t> rays_sent{ 0 };        /**< Rays sent (statistics) */
+  std::atomic<size_t> messages_stalled{ 0 }; /**< Messages held back for lack of credits (statistics) */
+};
+}
+}
+
+#endif /* GVT_RENDER_RAY_AGGREGATOR */
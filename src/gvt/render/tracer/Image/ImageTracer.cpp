@@ -29,6 +29,9 @@
 #include <gvt/core/utils/timer.h>
 namespace gvt {
 namespace render {
+namespace {
+const gvt::core::Atom THREADS("threads");
+}
 ImageTracer::ImageTracer() : gvt::render::RayTracer() {
   queue_mutex = new std::mutex[meshRef.size()];
   for (auto &m : meshRef) {
@@ -43,6 +46,7 @@ ImageTracer::~ImageTracer() {
 void ImageTracer::resetBVH() {
   RayTracer::resetBVH();
   if (queue_mutex != nullptr) delete[] queue_mutex;
+  queue_mutex = new std::mutex[meshRef.size()];
   for (auto &m : meshRef) {
     queue[m.first] = gvt::render::actor::RayVector();
   }
@@ -55,8 +59,7 @@ void ImageTracer::operator()() {
   gvt::core::time::timer t_frame(true, "image tracer: frame: ");
   gvt::core::time::timer t_all(false, "image tracer: all timers: ");
   gvt::core::time::timer t_gather(false, "image tracer: gather: ");
-  gvt::core::time::timer t_shuffle(false, "image tracer: shuffle: ");
-  gvt::core::time::timer t_tracer(false, "image tracer: adapter+trace : ");
+  gvt::core::time::timer t_tracer(false, "image tracer: adapter+trace+shuffle : ");
   gvt::core::time::timer t_select(false, "image tracer: select : ");
   gvt::core::time::timer t_filter(false, "image tracer: filter : ");
   gvt::core::time::timer t_camera(false, "image tracer: gen rays : ");
@@ -67,33 +70,21 @@ void ImageTracer::operator()() {
   t_filter.resume();
   processRaysAndDrop(cam->rays);
   t_filter.stop();
-  gvt::render::actor::RayVector returned_rays;
+  gvt::core::Vector<int> targets;
   do {
-    int target = -1;
-    int amount = 0;
     t_select.resume();
-    for (auto &q : queue) {
-      if (q.second.size() > amount) {
-        amount = q.second.size();
-        target = q.first;
-      }
-    }
+    selectQueues(targets, false);
     t_select.stop();
-    if (target != -1) {
+    if (!targets.empty()) {
       t_tracer.resume();
-      returned_rays.reserve(queue[target].size() * 10);
-      RayTracer::calladapter(target, queue[target], returned_rays);
-      queue[target].clear();
+      traceQueues(targets);
       t_tracer.stop();
-      t_shuffle.resume();
-      processRays(returned_rays, target);
-      t_shuffle.stop();
     }
   } while (hasWork());
   t_gather.resume();
   img->composite();
   t_gather.stop();
-  t_all = t_gather + t_shuffle + t_tracer + t_select + t_filter;
+  t_all = t_gather + t_tracer + t_select + t_filter;
 }
 
 void ImageTracer::processRaysAndDrop(gvt::render::actor::RayVector &rays) {
@@ -105,7 +96,7 @@ void ImageTracer::processRaysAndDrop(gvt::render::actor::RayVector &rays) {
 
   const int chunksize =
       MAX(GVT_SIMD_WIDTH,
-          ray_chunk / (gvt::core::CoreContext::instance()->getRootNode()["threads"].value().toInteger() * 4));
+          ray_chunk / (gvt::core::CoreContext::instance()->getRootNode()[THREADS].value().toInteger() * 4));
   gvt::render::data::accel::BVH &acc = *bvh.get();
   static tbb::simple_partitioner ap;
   tbb::parallel_for(tbb::blocked_range<gvt::render::actor::RayVector::iterator>(rays.begin() + ray_start,
@@ -123,13 +114,7 @@ void ImageTracer::processRaysAndDrop(gvt::render::actor::RayVector &rays) {
                           local_queue[hits[i].next].push_back(r);
                         }
                       }
-                      for (auto &q : local_queue) {
-                        queue_mutex[q.first].lock();
-                        queue[q.first].insert(queue[q.first].end(),
-                                              std::make_move_iterator(local_queue[q.first].begin()),
-                                              std::make_move_iterator(local_queue[q.first].end()));
-                        queue_mutex[q.first].unlock();
-                      }
+                      for (auto &q : local_queue) enqueue(q.first, q.second);
                     },
                     ap);
 
@@ -139,7 +124,7 @@ void ImageTracer::processRaysAndDrop(gvt::render::actor::RayVector &rays) {
 void ImageTracer::processRays(gvt::render::actor::RayVector &rays, const int src, const int dst) {
 
   const int chunksize =
-      MAX(4096, rays.size() / (gvt::core::CoreContext::instance()->getRootNode()["threads"].value().toInteger() * 4));
+      MAX(4096, rays.size() / (gvt::core::CoreContext::instance()->getRootNode()[THREADS].value().toInteger() * 4));
   gvt::render::data::accel::BVH &acc = *bvh.get();
   static tbb::simple_partitioner ap;
   tbb::parallel_for(tbb::blocked_range<gvt::render::actor::RayVector::iterator>(rays.begin(), rays.end(), chunksize),
@@ -158,13 +143,7 @@ void ImageTracer::processRays(gvt::render::actor::RayVector &rays, const int src
                           img->localAdd(r.id, r.color * r.w, 1.f, r.t);
                         }
                       }
-                      for (auto &q : local_queue) {
-                        queue_mutex[q.first].lock();
-                        queue[q.first].insert(queue[q.first].end(),
-                                              std::make_move_iterator(local_queue[q.first].begin()),
-                                              std::make_move_iterator(local_queue[q.first].end()));
-                        queue_mutex[q.first].unlock();
-                      }
+                      for (auto &q : local_queue) enqueue(q.first, q.second);
                     },
                     ap);
 
@@ -0,0 +1,249 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#include <gvt/render/tracer/QueuePriority.h>
+
+#include <utility>
+
+namespace gvt {
+namespace render {
+
+namespace {
+// indexed binary heap operations, p holds the position of each id in h (-1 if absent) and before(a, b) is true if a
+// ranks above b
+template <class Before> void siftUp(gvt::core::Vector<int> &h, gvt::core::Vector<int> &p, size_t i, Before before) {
+  while (i > 0) {
+    const size_t parent = (i - 1) / 2;
+    if (!before(h[i], h[parent])) break;
+    std::swap(h[parent], h[i]);
+    p[h[parent]] = parent;
+    p[h[i]] = i;
+    i = parent;
+  }
+}
+
+template <class Before> void siftDown(gvt::core::Vector<int> &h, gvt::core::Vector<int> &p, size_t i, Before before) {
+  const size_t n = h.size();
+  while (true) {
+    size_t largest = i;
+    const size_t l = 2 * i + 1;
+    const size_t r = 2 * i + 2;
+    if (l < n && before(h[l], h[largest])) largest = l;
+    if (r < n && before(h[r], h[largest])) largest = r;
+    if (largest == i) break;
+    std::swap(h[largest], h[i]);
+    p[h[largest]] = largest;
+    p[h[i]] = i;
+    i = largest;
+  }
+}
+
+template <class Before> void push(gvt::core::Vector<int> &h, gvt::core::Vector<int> &p, const int id, Before before) {
+  p[id] = h.size();
+  h.push_back(id);
+  siftUp(h, p, p[id], before);
+}
+
+template <class Before> void erase(gvt::core::Vector<int> &h, gvt::core::Vector<int> &p, const int id, Before before) {
+  const size_t i = p[id];
+  const int last = h.back();
+  h.pop_back();
+  p[id] = -1;
+  if (last == id) return;
+  h[i] = last;
+  p[last] = i;
+  siftUp(h, p, i, before);
+  siftDown(h, p, p[last], before);
+}
+
+template <class Before> void fix(gvt::core::Vector<int> &h, gvt::core::Vector<int> &p, const int id, Before before) {
+  siftUp(h, p, p[id], before);
+  siftDown(h, p, p[id], before);
+}
+}
+
+double ThroughputCostModel::priority(const QueueState &q, const MeshState &m) const {
+  const double work = double(q.rays - q.shadow) + shadowWeight * double(q.shadow);
+  if (work <= 0) return 0;
+  const double rate = (m.raysPerSecond > 0) ? m.raysPerSecond : defaultRate;
+  double time = work / rate + callOverhead;
+  if (!m.resident) time += (m.buildTime > 0) ? m.buildTime : defaultBuildTime;
+  return work / time;
+}
+
+QueuePriority::QueuePriority() : model(std::make_shared<ThroughputCostModel>()) {}
+QueuePriority::~QueuePriority() {}
+
+void QueuePriority::reset(const gvt::core::Map<int, gvt::render::data::primitives::Mesh *> &meshRef) {
+  std::lock_guard<std::mutex> _lock(_protect);
+  const size_t n = meshRef.empty() ? 0 : meshRef.rbegin()->first + 1;
+  heap.clear();
+  ready.clear();
+  pos.assign(n, -1);
+  slot.assign(n, -1);
+  key.assign(n, 0);
+  state.assign(n, QueueState());
+  _queued = 0;
+  schedulable.assign(n, true);
+  mesh.assign(n, nullptr);
+  instances.clear();
+
+  gvt::core::Map<gvt::render::data::primitives::Mesh *, MeshState> oldState;
+  std::swap(oldState, meshState);
+  for (auto &m : meshRef) {
+    mesh[m.first] = m.second;
+    instances[m.second].push_back(m.first);
+    auto it = oldState.find(m.second);
+    meshState[m.second] = (it != oldState.end()) ? it->second : MeshState();
+  }
+  for (auto &i : instances) {
+    for (const int &id : i.second) slot[id] = ready.size();
+    ready.push_back(gvt::core::Vector<int>());
+  }
+  meshPos.assign(ready.size(), -1);
+}
+
+void QueuePriority::setSchedulable(const int id, const bool s) {
+  std::lock_guard<std::mutex> _lock(_protect);
+  schedulable[id] = s;
+  update(id);
+}
+
+void QueuePriority::setCostModel(std::shared_ptr<QueueCostModel> m) {
+  std::lock_guard<std::mutex> _lock(_protect);
+  model = m;
+  for (size_t id = 0; id < mesh.size(); id++) update(id);
+}
+
+void QueuePriority::setMinBatch(const size_t m) {
+  std::lock_guard<std::mutex> _lock(_protect);
+  minBatch = (m > 0) ? m : 1;
+  // the ready queues rank above the others, every heap has to be rebuilt
+  auto byQueue = [this](const int a, const int b) { return before(a, b); };
+  auto byMesh = [this](const int a, const int b) { return meshBefore(a, b); };
+  for (auto &r : ready) {
+    gvt::core::Vector<int> ids;
+    std::swap(ids, r);
+    for (const int &id : ids) push(r, pos, id, byQueue);
+  }
+  gvt::core::Vector<int> slots;
+  std::swap(slots, heap);
+  for (const int &s : slots) push(heap, meshPos, s, byMesh);
+}
+
+void QueuePriority::enqueued(const int id, const size_t rays, const size_t shadow) {
+  std::lock_guard<std::mutex> _lock(_protect);
+  state[id].rays += rays;
+  state[id].shadow += shadow;
+  _queued += rays;
+  update(id);
+}
+
+void QueuePriority::dequeued(const int id) {
+  std::lock_guard<std::mutex> _lock(_protect);
+  _queued -= state[id].rays;
+  state[id] = QueueState();
+  update(id);
+}
+
+void QueuePriority::built(gvt::render::data::primitives::Mesh *m, const double seconds) {
+  std::lock_guard<std::mutex> _lock(_protect);
+  MeshState &ms = meshState[m];
+  ms.buildTime = seconds;
+  ms.resident = true;
+  for (const int &id : instances[m]) update(id);
+}
+
+void QueuePriority::released(gvt::render::data::primitives::Mesh *m) {
+  std::lock_guard<std::mutex> _lock(_protect);
+  meshState.erase(m);
+  auto it = instances.find(m);
+  if (it == instances.end()) return;
+  for (const int &id : it->second) update(id);
+}
+
+void QueuePriority::traced(gvt::render::data::primitives::Mesh *m, const size_t rays, const double seconds) {
+  if (rays == 0 || seconds <= 0) return;
+  std::lock_guard<std::mutex> _lock(_protect);
+  MeshState &ms = meshState[m];
+  const double rate = double(rays) / seconds;
+  ms.raysPerSecond = (ms.raysPerSecond > 0) ? 0.75 * ms.raysPerSecond + 0.25 * rate : rate;
+  for (const int &id : instances[m]) update(id);
+}
+
+void QueuePriority::select(gvt::core::Vector<int> &targets, const size_t max, const bool belowBatch) {
+  std::lock_guard<std::mutex> _lock(_protect);
+  targets.clear();
+  // best first walk of the top of the mesh heap (a node ranks above its children), each mesh gives its best instance
+  gvt::core::Vector<size_t> frontier;
+  if (!heap.empty()) frontier.push_back(0);
+  while (!frontier.empty() && targets.size() < max) {
+    size_t best = 0;
+    for (size_t f = 1; f < frontier.size(); f++)
+      if (meshBefore(heap[frontier[f]], heap[frontier[best]])) best = f;
+    const size_t i = frontier[best];
+    frontier[best] = frontier.back();
+    frontier.pop_back();
+    const int id = ready[heap[i]].front();
+    if (!belowBatch && state[id].rays < minBatch) break;
+    targets.push_back(id);
+    for (size_t c = 2 * i + 1; c <= 2 * i + 2 && c < heap.size(); c++) frontier.push_back(c);
+  }
+}
+
+bool QueuePriority::empty() {
+  std::lock_guard<std::mutex> _lock(_protect);
+  return heap.empty();
+}
+
+double QueuePriority::computeKey(const int id) { return model->priority(state[id], meshState[mesh[id]]); }
+
+void QueuePriority::update(const int id) {
+  const int s = slot[id];
+  if (s == -1) return;
+  auto byQueue = [this](const int a, const int b) { return before(a, b); };
+  if (!schedulable[id] || state[id].rays == 0) {
+    if (pos[id] != -1) erase(ready[s], pos, id, byQueue);
+  } else {
+    key[id] = computeKey(id);
+    if (pos[id] == -1)
+      push(ready[s], pos, id, byQueue);
+    else
+      fix(ready[s], pos, id, byQueue);
+  }
+  updateMesh(s);
+}
+
+void QueuePriority::updateMesh(const int s) {
+  auto byMesh = [this](const int a, const int b) { return meshBefore(a, b); };
+  if (ready[s].empty()) {
+    if (meshPos[s] != -1) erase(heap, meshPos, s, byMesh);
+  } else if (meshPos[s] == -1) {
+    push(heap, meshPos, s, byMesh);
+  } else {
+    fix(heap, meshPos, s, byMesh);
+  }
+}
+}
+}
@@ -0,0 +1,228 @@
+/* =======================================================================================
+   This file is released as part of GraviT - scalable, platform independent ray tracing
+   tacc.github.io/GraviT
+
+   Copyright 2013-2015 Texas Advanced Computing Center, The University of Texas at Austin
+   All rights reserved.
+
+   Licensed under the BSD 3-Clause License, (the "License"); you may not use this file
+   except in compliance with the License.
+   A copy of the License is included with this software in the file LICENSE.
+   If your copy does not contain the License, you may obtain a copy of the License at:
+
+       http://opensource.org/licenses/BSD-3-Clause
+
+   Unless required by applicable law or agreed to in writing, software distributed under
+   the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+   KIND, either express or implied.
+   See the License for the specific language governing permissions and limitations under
+   limitations under the License.
+
+   GraviT is funded in part by the US National Science Foundation under awards ACI-1339863,
+   ACI-1339881 and ACI-1339840
+   ======================================================================================= */
+
+#ifndef GVT_RENDER_QUEUEPRIORITY
+#define GVT_RENDER_QUEUEPRIORITY
+
+#include <gvt/core/Types.h>
+#include <gvt/render/data/primitives/Mesh.h>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+namespace gvt {
+namespace render {
+
+/**
+ * \brief Ray queue state used by the queue cost model
+ */
+struct QueueState {
+  size_t rays = 0;   /**< Number of rays in the queue */
+  size_t shadow = 0; /**< Number of shadow rays in the queue */
+};
+
+/**
+ * \brief Mesh state measured by the scheduler and used by the queue cost model
+ */
+struct MeshState {
+  double raysPerSecond = 0; /**< Measured adapter throughput (0 if not measured yet) */
+  double buildTime = 0;     /**< Measured adapter construction time in seconds (0 if not measured yet) */
+  bool resident = false;    /**< True if the mesh adapter is in the adapter cache */
+};
+
+/**
+ * \brief Queue cost model interface
+ *
+ * Computes the scheduling priority of an instance queue. The queue with the highest priority is traced first.
+ * Schedulers can replace the cost model at any time through RayTracer::setCostModel.
+ */
+class QueueCostModel {
+public:
+  virtual ~QueueCostModel() {}
+  /**
+   * \brief Priority of a queue
+   * @method priority
+   * @param  q        Queue state
+   * @param  m        State of the mesh referenced by the queue instance
+   * @return          Priority (higher is scheduled first)
+   */
+  virtual double priority(const QueueState &q, const MeshState &m) const = 0;
+};
+
+/**
+ * \brief Default cost model
+ *
+ * Ranks queues by the expected ray throughput of the adapter call: the weighted ray count divided by the estimated
+ * call time. The estimated time is the weighted ray count over the measured mesh throughput, plus a fixed call overhead
+ * and the adapter construction time if the adapter is not resident. Shadow rays only require an occlusion test and do
+ * not spawn new rays, thus they weight less than the other ray types.
+ */
+class ThroughputCostModel : public QueueCostModel {
+public:
+  double shadowWeight = 0.5;      /**< Weight of a shadow ray relative to other ray types */
+  double callOverhead = 1e-4;     /**< Fixed cost of an adapter call in seconds */
+  double defaultRate = 1e6;       /**< Throughput (rays/s) assumed for meshes not yet traced */
+  double defaultBuildTime = 1e-2; /**< Adapter construction time assumed for meshes not yet built */
+
+  virtual double priority(const QueueState &q, const MeshState &m) const;
+};
+
+/**
+ * \brief Indexed priority heap of instance queues
+ *
+ * Keeps the schedulable instance queues ordered by the cost model priority. The heap is updated when rays are
+ * enqueued or a queue is dequeued, and when the measured state of a mesh changes, so the scheduler does not need to
+ * scan all the queues to select the next ones to trace.
+ *
+ * The heap has two levels: the queued instances of each mesh are kept in a heap of their own, and the meshes are
+ * ordered by their best instance. Selecting queues of distinct meshes only walks the top of the mesh heap, so many
+ * instances of the same mesh (e.g. instanced forests or particles) do not slow down the selection.
+ *
+ * All methods are thread safe. To keep the heap consistent with the queues, enqueued and dequeued must be called while
+ * holding the queue mutex of the instance.
+ */
+class QueuePriority {
+public:
+  QueuePriority();
+  ~QueuePriority();
+
+  /**
+   * \brief Reset the heap for a new set of instances
+   *
+   * All instances are marked schedulable and all queues empty. Measured mesh state is kept for meshes that are still
+   * referenced.
+   *
+   * @method reset
+   * @param  meshRef Instance internal id to mesh map
+   */
+  void reset(const gvt::core::Map<int, gvt::render::data::primitives::Mesh *> &meshRef);
+
+  /**
+   * \brief Set if an instance queue can be selected (e.g. the instance data is available in the node)
+   */
+  void setSchedulable(const int id, const bool schedulable);
+
+  /**
+   * \brief Replace the cost model and update all priorities
+   */
+  void setCostModel(std::shared_ptr<QueueCostModel> model);
+
+  /**
+   * \brief Set the minimum number of rays for a queue to be ready to trace
+   *
+   * Queues with fewer rays are kept in the heap but are always ranked below the ready queues.
+   */
+  void setMinBatch(const size_t minBatch);
+
+  /**
+   * \brief Notify that rays were added to an instance queue
+   * @param id     Instance internal id
+   * @param rays   Number of rays added
+   * @param shadow Number of shadow rays among the added rays
+   */
+  void enqueued(const int id, const size_t rays, const size_t shadow);
+
+  /**
+   * \brief Notify that an instance queue was emptied
+   */
+  void dequeued(const int id);
+
+  /**
+   * \brief Notify that the adapter of a mesh was created and placed in the adapter cache
+   * @param mesh    Mesh
+   * @param seconds Adapter construction time
+   */
+  void built(gvt::render::data::primitives::Mesh *mesh, const double seconds);
+
+  /**
+   * \brief Notify that the adapter of a mesh was removed from the adapter cache
+   *
+   * Drops the measured state of the mesh, the mesh may be freed or replaced (e.g. by the next time step).
+   * @param mesh Mesh
+   */
+  void released(gvt::render::data::primitives::Mesh *mesh);
+
+  /**
+   * \brief Notify that rays were traced by the adapter of a mesh
+   * @param mesh    Mesh
+   * @param rays    Number of rays traced
+   * @param seconds Trace time
+   */
+  void traced(gvt::render::data::primitives::Mesh *mesh, const size_t rays, const double seconds);
+
+  /**
+   * \brief Select the highest priority queues
+   *
+   * Selects at most max queues in decreasing priority order, keeping at most one instance per mesh. The selected
+   * queues stay in the heap until they are dequeued.
+   *
+   * @method select
+   * @param  targets    Selected instance ids (highest priority first)
+   * @param  max        Maximum number of queues to select
+   * @param  belowBatch Also select queues with less rays than the minimum batch size
+   */
+  void select(gvt::core::Vector<int> &targets, const size_t max, const bool belowBatch = true);
+
+  /**
+   * \brief Check if there are schedulable queues with rays
+   */
+  bool empty();
+
+  /**
+   * \brief Total number of rays in the instance queues (does not lock the heap)
+   */
+  size_t queued() const { return _queued; }
+
+protected:
+  void update(const int id);
+  void updateMesh(const int s);
+  double computeKey(const int id);
+  inline bool before(const int a, const int b) {
+    const bool ra = state[a].rays >= minBatch;
+    const bool rb = state[b].rays >= minBatch;
+    return (ra != rb) ? ra : key[a] > key[b];
+  }
+  inline bool meshBefore(const int s, const int t) { return before(ready[s].front(), ready[t].front()); }
+
+  std::mutex _protect;                                           /**< Heap protection */
+  std::shared_ptr<QueueCostModel> model;                         /**< Current cost model */
+  size_t minBatch = 1;                                           /**< Minimum queue size to be ready to trace */
+  std::atomic<size_t> _queued{ 0 };                              /**< Rays in all the queues */
+  gvt::core::Vector<int> heap;                                   /**< Binary max heap of mesh slots with queues */
+  gvt::core::Vector<int> meshPos;                                /**< Heap position of each mesh slot (-1 if absent) */
+  gvt::core::Vector<gvt::core::Vector<int> > ready;              /**< Heap of the queued instances of each slot */
+  gvt::core::Vector<int> pos;                                    /**< Position of each instance in its mesh slot heap */
+  gvt::core::Vector<int> slot;                                   /**< Mesh slot of each instance (-1 if unused) */
+  gvt::core::Vector<double> key;                                 /**< Current priority of each instance */
+  gvt::core::Vector<QueueState> state;                           /**< Queue state of each instance */
+  gvt::core::Vector<bool> schedulable;                           /**< Instance can be selected */
+  gvt::core::Vector<gvt::render::data::primitives::Mesh *> mesh; /**< Mesh of each instance */
+  gvt::core::Map<gvt::render::data::primitives::Mesh *, MeshState> meshState;                /**< Measured state */
+  gvt::core::Map<gvt::render::data::primitives::Mesh *, gvt::core::Vector<int> > instances; /**< Mesh instances */
+};
+}
+}
+
+#endif /* GVT_RENDER_QUEUEPRIORITY */
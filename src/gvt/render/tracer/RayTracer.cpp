@@ -22,8 +22,10 @@
    ACI-1339881 and ACI-1339840
    ======================================================================================= */
 
+#include <algorithm>
 #include <cassert>
 #include <gvt/render/tracer/RayTracer.h>
+#include <chrono>
 #if 0
 #ifdef GVT_RENDER_ADAPTER_EMBREE
 #include <gvt/render/adapter/embree/EmbreeMeshAdapter.h>
@@ -81,55 +83,159 @@ void RayTracer::calladapter(const int instTarget, gvt::render::actor::RayVector
   std::shared_ptr<gvt::render::Adapter> adapter;
 
   gvt::render::data::primitives::Mesh *mesh = meshRef[instTarget];
-  auto it = adapterCache.find(mesh);
+  {
+    std::lock_guard<std::mutex> _lock(adapterCache_mutex);
+    auto it = adapterCache.find(mesh);
 
-  if (it != adapterCache.end()) {
-    adapter = it->second;
-  } else {
-    adapter = 0;
+    if (it != adapterCache.end()) {
+      adapter = it->second;
+    } else {
+      adapter = 0;
+    }
   }
 
   if (!adapter) {
-    switch (adapterType) {
+    prepareAdapter(mesh);
+    std::lock_guard<std::mutex> _lock(adapterCache_mutex);
+    adapter = adapterCache[mesh];
+  }
+  GVT_ASSERT(adapter != nullptr, "image scheduler: adapter not set");
+  {
+    const size_t rays = toprocess.size();
+    auto t_trace = std::chrono::high_resolution_clock::now();
+    moved_rays.reserve(toprocess.size() * 10);
+    adapter->trace(toprocess, moved_rays, &scene.m[instTarget], &scene.minv[instTarget], &scene.normi[instTarget],
+                   lights);
+    toprocess.clear();
+    queuePriority.traced(
+        mesh, rays, std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t_trace).count());
+  }
+}
+
+std::shared_ptr<gvt::render::Adapter> RayTracer::createAdapter(gvt::render::data::primitives::Mesh *mesh) {
+  std::shared_ptr<gvt::render::Adapter> adapter;
+  switch (adapterType) {
 #ifdef GVT_RENDER_ADAPTER_EMBREE
-    case gvt::render::adapter::Embree:
-      adapter = std::make_shared<gvt::render::adapter::embree::data::EmbreeMeshAdapter>(mesh);
-      break;
+  case gvt::render::adapter::Embree:
+    adapter = std::make_shared<gvt::render::adapter::embree::data::EmbreeMeshAdapter>(mesh);
+    break;
 #endif
 #ifdef GVT_RENDER_ADAPTER_EMBREE_STREAM
-    case gvt::render::adapter::EmbreeStream:
-      adapter = std::make_shared<gvt::render::adapter::embree::data::EmbreeStreamMeshAdapter>(mesh);
-      break;
+  case gvt::render::adapter::EmbreeStream:
+    adapter = std::make_shared<gvt::render::adapter::embree::data::EmbreeStreamMeshAdapter>(mesh);
+    break;
 #endif
 #ifdef GVT_RENDER_ADAPTER_MANTA
-    case gvt::render::adapter::Manta:
-      adapter = new gvt::render::adapter::manta::data::MantaMeshAdapter(mesh);
-      break;
+  case gvt::render::adapter::Manta:
+    adapter = new gvt::render::adapter::manta::data::MantaMeshAdapter(mesh);
+    break;
 #endif
 #ifdef GVT_RENDER_ADAPTER_OPTIX
-    case gvt::render::adapter::Optix:
-      adapter = new gvt::render::adapter::optix::data::OptixMeshAdapter(mesh);
-      break;
+  case gvt::render::adapter::Optix:
+    adapter = new gvt::render::adapter::optix::data::OptixMeshAdapter(mesh);
+    break;
 #endif
 
 #if defined(GVT_RENDER_ADAPTER_OPTIX) && defined(GVT_RENDER_ADAPTER_EMBREE)
-    case gvt::render::adapter::Heterogeneous:
-      adapter = new gvt::render::adapter::heterogeneous::data::HeterogeneousMeshAdapter(mesh);
-      break;
+  case gvt::render::adapter::Heterogeneous:
+    adapter = new gvt::render::adapter::heterogeneous::data::HeterogeneousMeshAdapter(mesh);
+    break;
 #endif
-    default:
-      GVT_ERR_MESSAGE("Image scheduler: unknown adapter type: " << adapterType);
-    }
-    adapterCache[mesh] = adapter;
+  default:
+    GVT_ERR_MESSAGE("Image scheduler: unknown adapter type: " << adapterType);
   }
-  GVT_ASSERT(adapter != nullptr, "image scheduler: adapter not set");
+  return adapter;
+}
+
+void RayTracer::prepareAdapter(gvt::render::data::primitives::Mesh *mesh) {
   {
-    moved_rays.reserve(toprocess.size() * 10);
-    adapter->trace(toprocess, moved_rays, instM[instTarget], instMinv[instTarget], instMinvN[instTarget], lights);
-    toprocess.clear();
+    std::lock_guard<std::mutex> _lock(adapterCache_mutex);
+    if (adapterCache.count(mesh)) return;
+  }
+  auto t_build = std::chrono::high_resolution_clock::now();
+  std::shared_ptr<gvt::render::Adapter> adapter = createAdapter(mesh);
+  std::lock_guard<std::mutex> _lock(adapterCache_mutex);
+  adapterCache[mesh] = adapter;
+  queuePriority.built(mesh,
+                      std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t_build).count());
+}
+
+void RayTracer::releaseAdapter(gvt::render::data::primitives::Mesh *mesh) {
+  std::lock_guard<std::mutex> _lock(adapterCache_mutex);
+  adapterCache.erase(mesh);
+  queuePriority.released(mesh);
+}
+
+void RayTracer::enqueue(const int instTarget, gvt::render::actor::RayVector &rays) {
+  size_t shadow = 0;
+  for (const gvt::render::actor::Ray &r : rays)
+    if (r.type == gvt::render::actor::Ray::SHADOW) shadow++;
+  std::lock_guard<std::mutex> _lock(queue_mutex[instTarget]);
+  gvt::render::actor::RayVector &q = queue[instTarget];
+  q.insert(q.end(), std::make_move_iterator(rays.begin()), std::make_move_iterator(rays.end()));
+  queuePriority.enqueued(instTarget, rays.size(), shadow);
+  rays.clear();
+}
+
+void RayTracer::selectQueues(gvt::core::Vector<int> &targets, const bool expectRays) {
+  static const gvt::core::Atom THREADS("threads");
+  const size_t maxQueues = std::max(1, cntxt->getRootNode()[THREADS].value().toInteger());
+  queuePriority.select(targets, maxQueues, false);
+  if (!targets.empty() || queuePriority.empty()) {
+    batchIdle = false;
+    return;
+  }
+
+  // only queues below the minimum batch size are left
+  auto now = std::chrono::high_resolution_clock::now();
+  if (!batchIdle) {
+    batchIdle = true;
+    batchIdleStart = now;
+  }
+  if (!expectRays || std::chrono::duration<double, std::milli>(now - batchIdleStart).count() >= batchTimeout) {
+    batchIdle = false;
+    queuePriority.select(targets, maxQueues, true);
   }
 }
 
+size_t RayTracer::traceQueues(const gvt::core::Vector<int> &targets) {
+  if (targets.empty()) return 0;
+
+  gvt::core::Vector<gvt::render::actor::RayVector> toprocess(targets.size());
+  size_t total = 0;
+  for (size_t i = 0; i < targets.size(); i++) {
+    std::lock_guard<std::mutex> _lock(queue_mutex[targets[i]]);
+    std::swap(queue[targets[i]], toprocess[i]);
+    queue[targets[i]].reserve(4096);
+    queuePriority.dequeued(targets[i]);
+    total += toprocess[i].size();
+  }
+
+  if (targets.size() == 1) {
+    gvt::render::actor::RayVector moved_rays;
+    calladapter(targets[0], toprocess[0], moved_rays);
+    processRays(moved_rays, targets[0]);
+    return total;
+  }
+
+  static const gvt::core::Atom THREADS("threads");
+  const size_t numThreads = std::max(1, cntxt->getRootNode()[THREADS].value().toInteger());
+  tbb::task_group tg;
+  for (size_t i = 0; i < targets.size(); i++) {
+    const int share = std::max((size_t)1, (numThreads * toprocess[i].size()) / total);
+    tg.run([&, i, share]() {
+      tbb::task_arena arena(share);
+      arena.execute([&]() {
+        gvt::render::actor::RayVector moved_rays;
+        calladapter(targets[i], toprocess[i], moved_rays);
+        processRays(moved_rays, targets[i]);
+      });
+    });
+  }
+  tg.wait();
+  return total;
+}
+
 float *RayTracer::getImageBuffer() { return img->composite(); };
 void RayTracer::resetCamera() {
   assert(cntxt != nullptr);
@@ -163,26 +269,19 @@ void RayTracer::resetBVH() {
   assert(cntxt != nullptr);
   gvt::core::DBNodeH rootnode = cntxt->getRootNode();
 
-  gvt::core::Vector<gvt::core::DBNodeH> instancenodes = rootnode["Instances"].getChildren();
   adapterType = rootnode["Schedule"]["adapter"].value().toInteger();
-  int numInst = instancenodes.size();
+  queuePriority.setMinBatch(rootnode["Schedule"]["minBatch"].value().toInteger());
+  batchTimeout = rootnode["Schedule"]["batchTimeout"].value().toFloat();
   meshRef.clear();
-  instM.clear();
-  instMinv.clear();
-  instMinvN.clear();
   for (auto &l : lights) {
     delete l;
   }
 
   lights.clear();
-  bvh = std::make_shared<gvt::render::data::accel::BVH>(instancenodes);
-  for (int i = 0; i < instancenodes.size(); i++) {
-    meshRef[i] =
-        (gvt::render::data::primitives::Mesh *)instancenodes[i]["meshRef"].deRef()["ptr"].value().toULongLong();
-    instM[i] = (glm::mat4 *)instancenodes[i]["mat"].value().toULongLong();
-    instMinv[i] = (glm::mat4 *)instancenodes[i]["matInv"].value().toULongLong();
-    instMinvN[i] = (glm::mat3 *)instancenodes[i]["normi"].value().toULongLong();
-  }
+  if (scene.update() || !bvh) bvh = std::make_shared<gvt::render::data::accel::BVH>(scene);
+  for (size_t i = 0; i < scene.size(); i++) meshRef[i] = scene.mesh[i];
+  queuePriority.reset(meshRef);
+  batchIdle = false;
   auto lightNodes = rootnode["Lights"].getChildren();
   lights.reserve(2);
   for (auto lightNode : lightNodes) {
@@ -32,15 +32,21 @@
 #include <gvt/render/composite/IceTComposite.h>
 #include <gvt/render/composite/ImageComposite.h>
 #include <gvt/render/data/accel/BVH.h>
+#include <gvt/render/data/scene/CompiledScene.h>
 #include <gvt/render/data/scene/gvtCamera.h>
+#include <gvt/render/tracer/QueuePriority.h>
 
 #include <tbb/blocked_range.h>
 #include <tbb/mutex.h>
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
 #include <tbb/partitioner.h>
+#include <tbb/task_arena.h>
+#include <tbb/task_group.h>
 #include <tbb/tick_count.h>
 
+#include <chrono>
+
 #ifdef GVT_RENDER_ADAPTER_EMBREE
 #include <gvt/render/adapter/embree/EmbreeMeshAdapter.h>
 #endif
@@ -85,16 +91,24 @@ protected:
   // Scheduling
   std::mutex *queue_mutex = nullptr;                        /**< Multi thread queue protectiob */
   gvt::core::Map<int, gvt::render::actor::RayVector> queue; /**< Ray queue for each instance in the scene */
+  QueuePriority queuePriority;                              /**< Priority of the schedulable instance queues */
+  double batchTimeout = 0;      /**< Idle time (ms) after which queues below the minimum batch size are traced */
+  bool batchIdle = false;       /**< True while only queues below the minimum batch size are available */
+  std::chrono::time_point<std::chrono::high_resolution_clock> batchIdleStart; /**< Start of the current idle period */
 
   // Caching
+  gvt::render::data::scene::CompiledScene scene; /**< Typed snapshot of the context instances */
   gvt::core::Map<int, gvt::render::data::primitives::Mesh *> meshRef; /**< Map mesh internal id to pointer in memory */
-  gvt::core::Map<int, glm::mat4 *> instM;                             /**< Mesh instance matrix model map */
-  gvt::core::Map<int, glm::mat4 *> instMinv;                          /**< Mesh instance inverse matrix model map */
-  gvt::core::Map<int, glm::mat3 *> instMinvN;                  /**< Mesh instance inverse matrix model map (3x3)*/
   gvt::core::Vector<gvt::render::data::scene::Light *> lights; /**< Scene lights */
   gvt::core::Map<gvt::render::data::primitives::Mesh *, std::shared_ptr<gvt::render::Adapter> >
       adapterCache /**< Tracer adapter cache */;
-  int adapterType; /**< Current adapter type */
+  std::mutex adapterCache_mutex; /**< Adapter cache protection when several queues are traced concurrently */
+  int adapterType;               /**< Current adapter type */
+
+  /**
+   * \brief Create the adapter of the current adapter type for a mesh (not cached)
+   */
+  std::shared_ptr<gvt::render::Adapter> createAdapter(gvt::render::data::primitives::Mesh *mesh);
 
 public:
   RayTracer();
@@ -123,6 +137,69 @@ public:
   void calladapter(const int instTarget, gvt::render::actor::RayVector &toprocess,
                    gvt::render::actor::RayVector &moved_rays);
 
+  /**
+   * \brief Build the adapter of a mesh ahead of its first trace
+   *
+   * Creates the adapter and places it in the cache, unless it is already cached. Can be called from another thread
+   * while rays are traced, e.g. to build the adapters of the next time step in the background (@see TimeSeries).
+   *
+   * @method prepareAdapter
+   * @param  mesh  Mesh the adapter is built for
+   */
+  void prepareAdapter(gvt::render::data::primitives::Mesh *mesh);
+
+  /**
+   * \brief Drop the cached adapter of a mesh
+   *
+   * Called before the mesh is freed, the adapter holds pointers to the mesh data.
+   *
+   * @method releaseAdapter
+   * @param  mesh  Mesh that will no longer be traced
+   */
+  void releaseAdapter(gvt::render::data::primitives::Mesh *mesh);
+
+  /**
+   * \brief Add rays to an instance queue
+   *
+   * Moves the rays to the instance queue and updates the queue priority. The rays vector is left empty.
+   *
+   * @method enqueue
+   * @param  instTarget  Instance internal identifier
+   * @param  rays        Rays to be added to the queue
+   */
+  void enqueue(const int instTarget, gvt::render::actor::RayVector &rays);
+
+  /**
+   * \brief Select the instance queues to be traced concurrently
+   *
+   * Takes the queues with the highest priority according to the current cost model (@see QueuePriority), at most one
+   * queue per available thread. Only one instance of each mesh is selected, since an adapter holds per trace call
+   * state and can not be shared by two concurrent tasks.
+   *
+   * Queues with less rays than the Schedule minBatch value are deferred so they can accumulate more rays. They are
+   * selected once no other queue is available for longer than the Schedule batchTimeout value (ms), or immediately if
+   * the scheduler does not expect rays from other sources.
+   *
+   * @method selectQueues
+   * @param  targets     Selected instance ids (highest priority first)
+   * @param  expectRays  True if rays may still arrive from other nodes
+   */
+  void selectQueues(gvt::core::Vector<int> &targets, const bool expectRays = true);
+
+  /**
+   * \brief Trace several instance queues concurrently
+   *
+   * Swaps each selected queue out under its mutex and launches one task per queue. Each task runs in a task arena
+   * with a share of the threads proportional to its share of the rays, calls the adapter and sorts the returned rays
+   * with processRays. A queue is owned by a single task while it is traced, so the rays of an instance are never
+   * traced by two tasks at the same time.
+   *
+   * @method traceQueues
+   * @param  targets     Instance ids returned by selectQueues
+   * @return             Number of rays traced
+   */
+  size_t traceQueues(const gvt::core::Vector<int> &targets);
+
   /**
    * Abstract method to process rays that where returned by the adapter call or a ray list list received from another
    * node
@@ -191,7 +268,8 @@ public:
   /**
    * \brief Reset BVH
    *
-   * Forces the BVH to check the render context for changes in the meshs and/or instances/
+   * Forces the BVH to check the render context for changes in the meshs and/or instances. The compiled scene is
+   * brought up to date and the BVH is only rebuilt if an instance changed.
    *
    * @method resetBVH
    */
@@ -201,6 +279,11 @@ public:
    * @return Current Image composite shared pointer
    */
   virtual std::shared_ptr<gvt::render::composite::ImageComposite> getComposite() { return img; }
+  /**
+   * \brief Replace the cost model used to prioritize the instance queues
+   * @param model New cost model
+   */
+  virtual void setCostModel(std::shared_ptr<QueueCostModel> model) { queuePriority.setCostModel(model); }
 };
 };
 };